@@ -39,6 +39,85 @@ LineIterator LineIterator::end() {
     return LineIterator();
 }
 
+ThreadPool::ThreadPool(size_t threadCount) {
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping or !tasks.empty(); });
+            if (stopping and tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    auto next = std::make_shared<std::atomic<size_t>>(0);
+    std::vector<std::future<void>> running;
+    const size_t taskCount = std::min(count, workers.size());
+    for (size_t t = 0; t < taskCount; ++t) {
+        running.push_back(submit([next, count, &body]() {
+            for (size_t i = (*next)++; i < count; i = (*next)++) {
+                body(i);
+            }
+        }));
+    }
+    // every task has to finish before body goes out of scope, even if one of them threw
+    std::exception_ptr failure;
+    for (auto& task : running) {
+        try {
+            task.get();
+        } catch (...) {
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+ThreadPool& defaultPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+std::string toString(uint128_t value) {
+    std::string digits;
+    do {
+        digits.push_back(static_cast<char>('0' + static_cast<int>(value % 10)));
+        value /= 10;
+    } while (value != 0);
+    return {digits.rbegin(), digits.rend()};
+}
+
 std::vector<std::string> readTextFile(const char* filename) {
     std::vector<std::string> lines;
     std::ifstream file(filename);
@@ -1,15 +1,23 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <numeric>
+#include <queue>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -35,6 +43,53 @@ class LineIterator {
 
 std::vector<std::string> readLinesFromFile(const std::string&);
 
+using uint128_t = unsigned __int128;
+using int128_t = __int128;
+
+// decimal digits of a 128-bit value, which the standard streams cannot print
+std::string toString(uint128_t value);
+
+// Fixed set of worker threads fed from one task queue.
+// Tasks must not wait on other tasks of the same pool.
+class ThreadPool {
+   private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping{false};
+
+    void workerLoop();
+
+   public:
+    explicit ThreadPool(size_t threadCount = std::max(1u, std::thread::hardware_concurrency()));
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const;
+
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task) {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([packaged]() { (*packaged)(); });
+        }
+        condition.notify_one();
+        return result;
+    }
+
+    // Calls body(i) for every i in [0, count), indices are handed out one at a time
+    // so uneven work balances itself. Blocks until done and rethrows the first exception.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+};
+
+// shared pool sized to the hardware
+ThreadPool& defaultPool();
+
 template <size_t N>
 std::array<std::string, N> readLinesFromFile(const std::string& filename) {
     std::array<std::string, N> lines;
@@ -152,6 +207,24 @@ std::array<T, N> extractNumbers(const std::string_view& line) {
     return numbers;
 }
 
+// Transposes the top-left size x size corner of a 64x64 bit matrix in place, size a power of
+// two: bit c of block[r] ends up as bit r of block[c]. Each round swaps the off-diagonal
+// quadrants of every 2j x 2j sub-block; smaller sizes skip the rounds above them.
+inline void transpose64(std::array<uint64_t, 64>& block, size_t size = 64) {
+    constexpr std::array<uint64_t, 6> masks{0x5555555555555555ull, 0x3333333333333333ull, 0x0F0F0F0F0F0F0F0Full,
+                                            0x00FF00FF00FF00FFull, 0x0000FFFF0000FFFFull, 0x00000000FFFFFFFFull};
+    for (size_t j{size / 2}; j != 0; j >>= 1) {
+        const uint64_t mask{masks[std::countr_zero(j)]};
+        for (size_t base{0}; base < size; base += 2 * j) {
+            for (size_t k{base}; k < base + j; ++k) {
+                const uint64_t swap{((block[k] >> j) ^ block[k + j]) & mask};
+                block[k] ^= swap << j;
+                block[k + j] ^= swap;
+            }
+        }
+    }
+}
+
 template <typename T>
 std::string vectorToString(const std::vector<T>& vec) {
     if (vec.empty()) {
@@ -1,4 +1,8 @@
+#include <limits>
 #include <map>
+#include <optional>
+#include <random>
+#include <span>
 #include <sstream>
 
 #include "FileData.hpp"
@@ -216,14 +220,449 @@ int64_t solution_two() {
 }
 }  // namespace original
 
+namespace optimized {
+
+// The almanac lists its maps in chain order (seed -> soil -> ... -> location),
+// so stages are addressed by their position instead of by name.
+enum Stage : size_t { seedToSoil,
+                      soilToFertilizer,
+                      fertilizerToWater,
+                      waterToLight,
+                      lightToTemperature,
+                      temperatureToHumidity,
+                      humidityToLocation,
+                      stageCount };
+
+class NumberMapper {
+   public:
+    NumberMapper() = default;
+
+    // Builds a flat breakpoint table covering the whole int64_t domain:
+    // starts_[i] is the first number of piece i, deltas_[i] the offset applied to it.
+    // Gaps between the given ranges become pieces with delta 0.
+    explicit NumberMapper(std::vector<original::MapEntry> mappings) {
+        std::sort(mappings.begin(), mappings.end(), [](const original::MapEntry& a, const original::MapEntry& b) {
+            return a.sourceStart < b.sourceStart;
+        });
+
+        starts_.push_back(std::numeric_limits<int64_t>::min());
+        deltas_.push_back(0);
+        for (const auto& mapping : mappings) {
+            if (mapping.rangeLength <= 0) {
+                continue;
+            }
+            if (mapping.sourceStart < starts_.back()) {
+                throw std::invalid_argument("overlapping ranges in map");
+            }
+            const int64_t end = mapping.sourceStart + mapping.rangeLength;
+            if (mapping.sourceStart == starts_.back()) {
+                deltas_.back() = mapping.destStart - mapping.sourceStart;
+            } else {
+                starts_.push_back(mapping.sourceStart);
+                deltas_.push_back(mapping.destStart - mapping.sourceStart);
+            }
+            starts_.push_back(end);
+            deltas_.push_back(0);
+        }
+    }
+
+    // index of the piece containing number, branchless binary search
+    [[nodiscard]] size_t pieceOf(int64_t number) const {
+        const int64_t* base = starts_.data();
+        size_t length = starts_.size();
+        while (length > 1) {
+            const size_t half = length / 2;
+            base = (base[half] <= number) ? base + half : base;
+            length -= half;
+        }
+        return static_cast<size_t>(base - starts_.data());
+    }
+
+    [[nodiscard]] int64_t mapNumber(int64_t number) const {
+        return number + deltas_[pieceOf(number)];
+    }
+
+    void mapMany(std::span<int64_t> numbers) const {
+        for (int64_t& number : numbers) {
+            number = mapNumber(number);
+        }
+    }
+
+    // Maps the half-open range [first, last) and appends the resulting ranges to out.
+    void mapRange(int64_t first, int64_t last, std::vector<std::pair<int64_t, int64_t>>& out) const {
+        size_t piece = pieceOf(first);
+        while (first < last) {
+            const int64_t pieceEnd = piece + 1 < starts_.size() ? starts_[piece + 1] : std::numeric_limits<int64_t>::max();
+            const int64_t chunkEnd = std::min(last, pieceEnd);
+            out.emplace_back(first + deltas_[piece], chunkEnd + deltas_[piece]);
+            first = chunkEnd;
+            ++piece;
+        }
+    }
+
+    [[nodiscard]] int64_t pieceEnd(size_t piece) const {
+        return piece + 1 < starts_.size() ? starts_[piece + 1] : std::numeric_limits<int64_t>::max();
+    }
+
+    // Folds two stages into one table equivalent to second.mapNumber(first.mapNumber(x)).
+    // Every piece of first is split where its image crosses a breakpoint of second.
+    static NumberMapper compose(const NumberMapper& first, const NumberMapper& second) {
+        NumberMapper result;
+        for (size_t i = 0; i < first.starts_.size(); ++i) {
+            const int64_t delta = first.deltas_[i];
+            const int64_t last = first.pieceEnd(i);
+            int64_t current = first.starts_[i];
+            size_t j = second.pieceOf(current + delta);
+            while (current < last) {
+                const int64_t chunkEnd = j + 1 < second.starts_.size() ? std::min(last, second.starts_[j + 1] - delta) : last;
+                result.append(current, delta + second.deltas_[j]);
+                current = chunkEnd;
+                ++j;
+            }
+        }
+        return result;
+    }
+
+    [[nodiscard]] const std::vector<int64_t>& starts() const { return starts_; }
+    [[nodiscard]] const std::vector<int64_t>& deltas() const { return deltas_; }
+
+   private:
+    std::vector<int64_t> starts_;
+    std::vector<int64_t> deltas_;
+
+    // adds a piece, merging it into the previous one if the delta is unchanged
+    void append(int64_t start, int64_t delta) {
+        if (!deltas_.empty() and deltas_.back() == delta) {
+            return;
+        }
+        starts_.push_back(start);
+        deltas_.push_back(delta);
+    }
+};
+
+// The composed mapper's pieces ordered by the location they map to,
+// i.e. the inverse function location -> seed piece.
+class InverseMapper {
+   public:
+    struct Piece {
+        int64_t locationStart;
+        int64_t seedStart;
+        int64_t seedEnd;
+    };
+
+    explicit InverseMapper(const NumberMapper& mapper) {
+        const auto& starts{mapper.starts()};
+        const auto& deltas{mapper.deltas()};
+        // every piece, including the identity tails below and above all mapped numbers
+        for (size_t i = 0; i < starts.size(); ++i) {
+            pieces_.push_back(Piece{starts[i] + deltas[i], starts[i], mapper.pieceEnd(i)});
+        }
+        std::sort(pieces_.begin(), pieces_.end(), [](const Piece& a, const Piece& b) {
+            return a.locationStart < b.locationStart;
+        });
+    }
+
+    // all seeds that end up at location; the mapping need not be injective
+    [[nodiscard]] std::vector<int64_t> seedsFor(int64_t location) const {
+        std::vector<int64_t> seeds;
+        for (const auto& piece : pieces_) {
+            if (piece.locationStart > location) {
+                break;
+            }
+            // the shift of the piece; seed - seedStart may not fit for the tails
+            const int64_t seed = location - (piece.locationStart - piece.seedStart);
+            if (seed >= piece.seedStart and seed < piece.seedEnd) {
+                seeds.push_back(seed);
+            }
+        }
+        return seeds;
+    }
+
+    // Lowest location reachable from the half-open seed ranges. Pieces are scanned
+    // in location order, so the scan stops as soon as no later piece can do better.
+    [[nodiscard]] int64_t lowestLocation(const std::vector<std::pair<int64_t, int64_t>>& seedRanges) const {
+        std::optional<int64_t> best;
+        for (const auto& piece : pieces_) {
+            if (best and piece.locationStart >= *best) {
+                break;
+            }
+            for (const auto& [first, last] : seedRanges) {
+                const int64_t lo = std::max(first, piece.seedStart);
+                if (lo < std::min(last, piece.seedEnd)) {
+                    const int64_t location = lo + (piece.locationStart - piece.seedStart);
+                    best = best ? std::min(*best, location) : location;
+                }
+            }
+        }
+        if (!best) {
+            throw std::invalid_argument("no seeds in the seed ranges");
+        }
+        return *best;
+    }
+
+   private:
+    std::vector<Piece> pieces_;
+};
+
+struct Almanac {
+    std::vector<int64_t> seeds;
+    std::array<NumberMapper, stageCount> stages;
+};
+
+Almanac parseAlmanac() {
+    Almanac almanac;
+    size_t stage{0};
+    std::string expectedSource{"seed"};
+    std::vector<original::MapEntry> entries;
+
+    auto finishStage = [&]() {
+        if (stage >= stageCount) {
+            throw std::invalid_argument("too many maps in almanac");
+        }
+        almanac.stages[stage++] = NumberMapper{std::move(entries)};
+        entries.clear();
+    };
+
+    bool readingMap{false};
+    for (const std::string_view line : input::inputContent) {
+        if (original::isSeedLine(line)) {
+            almanac.seeds = original::extractSeeds(line);
+        } else if (!readingMap and original::isMapNameLine(line)) {
+            auto [source, destination] = original::extractMapName(line);
+            if (source != expectedSource) {
+                throw std::invalid_argument("map " + source + " is out of chain order");
+            }
+            expectedSource = destination;
+            readingMap = true;
+        } else if (readingMap and original::isMapEntry(line)) {
+            entries.push_back(original::extractEntry(line));
+        } else if (readingMap and line.empty()) {
+            readingMap = false;
+            finishStage();
+        }
+    }
+    if (readingMap) {
+        finishStage();
+    }
+    if (stage != stageCount or expectedSource != "location") {
+        throw std::invalid_argument("almanac does not map seed to location");
+    }
+    return almanac;
+}
+
+NumberMapper composeStages(const std::array<NumberMapper, stageCount>& stages) {
+    NumberMapper composed{stages[0]};
+    for (size_t stage = 1; stage < stageCount; ++stage) {
+        composed = NumberMapper::compose(composed, stages[stage]);
+    }
+    return composed;
+}
+
+// half-open ranges from the (start, length) seed pairs; empty ranges are skipped
+std::vector<std::pair<int64_t, int64_t>> seedRanges(const std::vector<int64_t>& seeds) {
+    if (seeds.size() % 2 != 0) {
+        throw std::invalid_argument("seed line has an odd number of values");
+    }
+    std::vector<std::pair<int64_t, int64_t>> ranges;
+    for (size_t i = 0; i < seeds.size(); i += 2) {
+        if (seeds[i + 1] < 0) {
+            throw std::invalid_argument("negative seed range length");
+        }
+        if (seeds[i + 1] > 0) {
+            ranges.emplace_back(seeds[i], seeds[i] + seeds[i + 1]);
+        }
+    }
+    if (ranges.empty()) {
+        throw std::invalid_argument("no seeds in the seed ranges");
+    }
+    return ranges;
+}
+
+int64_t solution_one() {
+    try {
+        Almanac almanac{parseAlmanac()};
+        for (const auto& mapper : almanac.stages) {
+            mapper.mapMany(almanac.seeds);
+        }
+        return *std::min_element(almanac.seeds.begin(), almanac.seeds.end());
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+int64_t solution_one_composed() {
+    try {
+        Almanac almanac{parseAlmanac()};
+        composeStages(almanac.stages).mapMany(almanac.seeds);
+        return *std::min_element(almanac.seeds.begin(), almanac.seeds.end());
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// lowest location of the seed ranges, pushing the ranges through the stages one by one;
+// mapping never drops numbers, so the non-empty ranges from seedRanges stay non-empty
+int64_t lowestLocationByStage(const std::array<NumberMapper, stageCount>& stages, std::vector<std::pair<int64_t, int64_t>> ranges) {
+    std::vector<std::pair<int64_t, int64_t>> next;
+    for (const auto& mapper : stages) {
+        next.clear();
+        for (const auto& [first, last] : ranges) {
+            mapper.mapRange(first, last, next);
+        }
+        std::swap(ranges, next);
+    }
+    return std::min_element(ranges.begin(), ranges.end())->first;
+}
+
+int64_t solution_two() {
+    try {
+        Almanac almanac{parseAlmanac()};
+        return lowestLocationByStage(almanac.stages, seedRanges(almanac.seeds));
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+int64_t solution_two_composed() {
+    try {
+        Almanac almanac{parseAlmanac()};
+        const NumberMapper composed{composeStages(almanac.stages)};
+        return InverseMapper{composed}.lowestLocation(seedRanges(almanac.seeds));
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// maps 1e6 random seeds drawn from the input's seed ranges, stage by stage versus composed,
+// and checks both part two strategies agree on the input
+void benchmark_queries() {
+    try {
+        constexpr size_t queryCount{1'000'000};
+        constexpr size_t n{10};
+
+        const Almanac almanac{parseAlmanac()};
+        const NumberMapper composed{composeStages(almanac.stages)};
+        const auto ranges{seedRanges(almanac.seeds)};
+
+        std::mt19937_64 rng{2023};
+        std::vector<int64_t> queries(queryCount);
+        for (auto& query : queries) {
+            const auto& [first, last] = ranges[rng() % ranges.size()];
+            query = first + static_cast<int64_t>(rng() % static_cast<uint64_t>(last - first));
+        }
+
+        std::vector<int64_t> perStage, folded;
+        std::cout << "1e6 queries, per stage:\n";
+        utils::benchmark<n>([&]() {
+            perStage = queries;
+            for (const auto& mapper : almanac.stages) {
+                mapper.mapMany(perStage);
+            }
+        });
+        std::cout << "1e6 queries, composed:\n";
+        utils::benchmark<n>([&]() {
+            folded = queries;
+            composed.mapMany(folded);
+        });
+        if (perStage != folded) {
+            throw std::logic_error("composed mapping disagrees with per-stage mapping");
+        }
+        if (InverseMapper{composed}.lowestLocation(ranges) != lowestLocationByStage(almanac.stages, ranges)) {
+            throw std::logic_error("composed lowest location disagrees with per-stage ranges");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// Both part two strategies against original::NumberMapper applied to every seed, on small
+// almanacs: one whose seed range runs past all mapped numbers into the upper identity tail
+// (seeds 5 15, a single map line 1000 0 10, expected 10), and random ones.
+void check_against_original() {
+    try {
+        using StageEntries = std::array<std::vector<original::MapEntry>, stageCount>;
+        auto check = [](const std::vector<int64_t>& seeds, const StageEntries& entries) {
+            std::vector<original::NumberMapper> chain;
+            std::array<NumberMapper, stageCount> stages;
+            for (size_t stage = 0; stage < stageCount; ++stage) {
+                std::vector<original::MapEntry> copy{entries[stage]};
+                chain.emplace_back("", "", copy);
+                stages[stage] = NumberMapper{entries[stage]};
+            }
+
+            int64_t expected{std::numeric_limits<int64_t>::max()};
+            for (size_t i = 0; i + 1 < seeds.size(); i += 2) {
+                for (int64_t seed = seeds[i]; seed < seeds[i] + seeds[i + 1]; ++seed) {
+                    int64_t number{seed};
+                    for (const auto& mapper : chain) {
+                        number = mapper.mapNumber(number);
+                    }
+                    expected = std::min(expected, number);
+                }
+            }
+
+            const auto ranges{seedRanges(seeds)};
+            if (lowestLocationByStage(stages, ranges) != expected or InverseMapper{composeStages(stages)}.lowestLocation(ranges) != expected) {
+                throw std::logic_error("optimized lowest location disagrees with original");
+            }
+        };
+
+        StageEntries tail;
+        tail[seedToSoil].push_back({1000, 0, 10});
+        check({5, 15}, tail);
+
+        std::mt19937_64 rng{5};
+        for (size_t round = 0; round < 1000; ++round) {
+            StageEntries entries;
+            for (auto& stage : entries) {
+                int64_t cursor = static_cast<int64_t>(rng() % 20);
+                for (size_t k = rng() % 5; k > 0; --k) {
+                    const int64_t length = 1 + static_cast<int64_t>(rng() % 15);
+                    stage.push_back({static_cast<int64_t>(rng() % 120), cursor, length});
+                    cursor += length + static_cast<int64_t>(rng() % 10);
+                }
+            }
+            std::vector<int64_t> seeds;
+            for (size_t k = 1 + rng() % 3; k > 0; --k) {
+                seeds.push_back(static_cast<int64_t>(rng() % 120));
+                seeds.push_back(1 + static_cast<int64_t>(rng() % 30));
+            }
+            check(seeds, entries);
+        }
+        std::cout << "Lowest locations agree with original on the edge case and 1000 random almanacs\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
     std::cout << "Part 1: " << original::solution_one() << std::endl;
     utils::benchmark<n>(original::solution_one);
 
-    std::cout << "Part 2: " << original::solution_two() << std::endl;
-    utils::benchmark<n>(original::solution_two);
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 1 (composed): " << optimized::solution_one_composed() << std::endl;
+    utils::benchmark<n>(optimized::solution_one_composed);
+
+    // original::solution_two brute-forces every seed and takes minutes, so only the range-mapping versions are run
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    std::cout << "Part 2 (composed): " << optimized::solution_two_composed() << std::endl;
+    utils::benchmark<n>(optimized::solution_two_composed);
+
+    optimized::check_against_original();
+    optimized::benchmark_queries();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -1,3 +1,8 @@
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <random>
+
 #include "FileData.hpp"
 #include "utils.hpp"
 
@@ -69,6 +74,154 @@ uint64_t solution_two() {
 }
 }  // namespace original
 
+namespace optimized {
+
+using utils::uint128_t;
+
+// floor(sqrt(n)) for any 128-bit n, the floating point estimate is corrected exactly
+uint64_t isqrt(uint128_t n) {
+    // the estimate can round up to 2^64, which does not convert to uint64_t
+    const long double estimate = std::sqrt(static_cast<long double>(n));
+    uint64_t root = estimate >= 0x1p64L ? std::numeric_limits<uint64_t>::max() : static_cast<uint64_t>(estimate);
+    while (static_cast<uint128_t>(root) * root > n) {
+        --root;
+    }
+    while (root != std::numeric_limits<uint64_t>::max() and static_cast<uint128_t>(root + 1) * (root + 1) <= n) {
+        ++root;
+    }
+    return root;
+}
+
+// Number of hold times t in [0, duration] with t * (duration - t) > record_distance.
+// The winning times form the interval [lower, duration - lower], lower is the first
+// integer above the smaller root of t^2 - duration * t + record_distance.
+uint64_t countOptimalChargingTimes(uint64_t duration, uint64_t record_distance) {
+    const uint128_t square = static_cast<uint128_t>(duration) * duration;
+    const uint128_t fourRecord = static_cast<uint128_t>(record_distance) * 4;
+    if (square <= fourRecord) {
+        return 0;
+    }
+
+    const uint64_t root = isqrt(square - fourRecord);
+    uint64_t lower = (duration - root) / 2;
+    auto beats = [&](uint64_t t) {
+        return static_cast<uint128_t>(t) * (duration - t) > record_distance;
+    };
+    while (lower <= duration / 2 and !beats(lower)) {
+        ++lower;
+    }
+    while (lower > 0 and beats(lower - 1)) {
+        --lower;
+    }
+    if (lower > duration / 2) {
+        return 0;
+    }
+    return duration - 2 * lower + 1;
+}
+
+// concatenates the decimal digits of all numbers, e.g. {40, 81} -> 4081
+uint64_t concatNumbers(const std::vector<uint64_t>& numbers) {
+    uint64_t result{0};
+    for (uint64_t number : numbers) {
+        uint64_t scale{10};
+        while (scale <= number and scale <= std::numeric_limits<uint64_t>::max() / 10) {
+            scale *= 10;
+        }
+        if (scale <= number) {
+            // 20 digits: 10^20 does not fit, so nothing may come before this number
+            if (result != 0) {
+                throw std::overflow_error("concatenated number does not fit into 64 bits");
+            }
+            result = number;
+            continue;
+        }
+        if (__builtin_mul_overflow(result, scale, &result) or __builtin_add_overflow(result, number, &result)) {
+            throw std::overflow_error("concatenated number does not fit into 64 bits");
+        }
+    }
+    return result;
+}
+
+uint64_t solution_one() {
+    try {
+        auto durations = original::extractDurations(input::content[0]);
+        auto records = original::extractRecords(input::content[1]);
+        if (durations.size() != records.size()) {
+            throw std::invalid_argument("number of durations and records differ");
+        }
+        uint64_t result{1};
+        for (size_t i = 0; i < durations.size(); ++i) {
+            result *= countOptimalChargingTimes(durations[i], records[i]);
+        }
+        return result;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_two() {
+    try {
+        uint64_t duration = concatNumbers(original::extractDurations(input::content[0]));
+        uint64_t record = concatNumbers(original::extractRecords(input::content[1]));
+        return countOptimalChargingTimes(duration, record);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// writes count lines of "time distance" with distances below the best possible one
+void generateRaces(const std::filesystem::path& path, size_t count) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file: " + path.string());
+    }
+    std::mt19937_64 rng{2023};
+    for (size_t i = 0; i < count; ++i) {
+        // at least 2, a duration of 1 cannot cover any distance and best would be 0
+        const uint64_t duration = 2 + rng() % 4'000'000'000ULL;
+        const uint64_t best = (duration / 2) * (duration - duration / 2);
+        file << duration << ' ' << rng() % best << '\n';
+    }
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> readRaces(const std::filesystem::path& path) {
+    std::vector<std::pair<uint64_t, uint64_t>> races;
+    for (const std::string& line : utils::LineIterator(path.string())) {
+        auto numbers = utils::extractNumbers<uint64_t, 2>(line);
+        races.emplace_back(numbers[0], numbers[1]);
+    }
+    return races;
+}
+
+// solves millions of generated races to measure the solver's throughput
+void benchmark_batch() {
+    try {
+        constexpr size_t raceCount{2'000'000};
+        constexpr size_t n{10};
+
+        const auto path = std::filesystem::temp_directory_path() / "day06_races.txt";
+        generateRaces(path, raceCount);
+        const auto races = readRaces(path);
+        std::filesystem::remove(path);
+
+        uint64_t checksum{0};
+        std::cout << races.size() << " generated races:\n";
+        utils::benchmark<n>([&]() {
+            checksum = 0;
+            for (const auto& [duration, record] : races) {
+                checksum += countOptimalChargingTimes(duration, record);
+            }
+        });
+        std::cout << "Checksum: " << checksum << '\n';
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
@@ -78,5 +231,13 @@ int main() {
     std::cout << "Part 2: " << original::solution_two() << std::endl;
     utils::benchmark<n>(original::solution_two);
 
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    optimized::benchmark_batch();
+
     return 0;
 }
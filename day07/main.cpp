@@ -1,5 +1,8 @@
 #include <map>
+#include <random>
 #include <set>
+#include <span>
+#include <utility>
 
 #include "FileData.hpp"
 #include "utils.hpp"
@@ -258,6 +261,296 @@ uint64_t solution_two() {
 }
 }  // namespace original
 
+namespace optimized {
+
+// A hand packed into one integer that orders like original::compare:
+// bits 20..22 hold the Type, bits 16..19 the first card, ..., bits 0..3 the fifth card.
+constexpr uint32_t typeShift{20};
+constexpr uint32_t keyBits{23};
+
+struct RankedHand {
+    uint32_t key;
+    uint32_t bid;
+};
+
+constexpr original::Type typeFromCounts(uint8_t highest, uint8_t second) {
+    using enum original::Type;
+    switch (highest) {
+        case 5:
+            return fiveOfAKind;
+        case 4:
+            return fourOfAKind;
+        case 3:
+            return second == 2 ? fullHouse : threeOfAKind;
+        case 2:
+            return second == 2 ? twoPair : onePair;
+        default:
+            return highCard;
+    }
+}
+
+// char -> Card for both rule sets, 0xFF marks characters that are no card
+constexpr uint8_t invalidRank{0xFF};
+
+constexpr std::array<uint8_t, 256> buildRankTable(bool withJoker) {
+    constexpr std::string_view faces{"23456789TJQKA"};
+    std::array<uint8_t, 256> table{};
+    table.fill(invalidRank);
+    for (size_t i{0}; i < faces.size(); ++i) {
+        table[static_cast<uint8_t>(faces[i])] = static_cast<uint8_t>(original::two + i);
+    }
+    if (withJoker) {
+        table['J'] = original::joker;
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> cardRanks{buildRankTable(false)};
+constexpr std::array<uint8_t, 256> jokerCardRanks{buildRankTable(true)};
+static_assert(cardRanks['J'] == original::jack and jokerCardRanks['J'] == original::joker);
+static_assert(cardRanks['A'] == original::ace and jokerCardRanks['T'] == original::ten);
+
+// The sorted count signature of the non-joker cards, e.g. (3,1,1), is identified by the
+// sum of its squared counts (distinct for every partition of at most five cards), which
+// equals #cards + 2 * #equal pairs and needs no counting or sorting to compute.
+constexpr size_t signatureStride{26};
+constexpr size_t signatureCount{6 * signatureStride};
+
+constexpr size_t signatureIndex(size_t jokers, size_t sumOfSquares) {
+    return jokers * signatureStride + sumOfSquares;
+}
+
+constexpr std::array<original::Type, signatureCount> buildTypeTable() {
+    std::array<original::Type, signatureCount> table{};
+    std::array<bool, signatureCount> seen{};
+    for (uint8_t a{0}; a <= 5; ++a) {
+        for (uint8_t b{0}; b <= a; ++b) {
+            for (uint8_t c{0}; c <= b; ++c) {
+                for (uint8_t d{0}; d <= c; ++d) {
+                    for (uint8_t e{0}; e <= d; ++e) {
+                        const size_t cards = a + b + c + d + e;
+                        if (cards > 5) {
+                            continue;
+                        }
+                        // jokers always join the largest group of other cards
+                        const size_t jokers = 5 - cards;
+                        const size_t index = signatureIndex(jokers, a * a + b * b + c * c + d * d + e * e);
+                        const original::Type type = typeFromCounts(static_cast<uint8_t>(a + jokers), b);
+                        if (seen[index] and table[index] != type) {
+                            throw std::logic_error("count signatures collide");
+                        }
+                        table[index] = type;
+                        seen[index] = true;
+                    }
+                }
+            }
+        }
+    }
+    return table;
+}
+
+constexpr std::array<original::Type, signatureCount> typeTable{buildTypeTable()};
+static_assert(typeTable[signatureIndex(0, 3 * 3 + 1 + 1)] == original::threeOfAKind);
+static_assert(typeTable[signatureIndex(2, 3)] == original::threeOfAKind);
+static_assert(typeTable[signatureIndex(1, 2 * 2 + 2 * 2)] == original::fullHouse);
+
+// branch free; classifyMany runs the same steps over a block of hands at once
+inline uint32_t keyFromRanks(const std::array<uint8_t, 5>& ranks, bool withJoker) {
+    uint32_t jokers{0}, equalPairs{0}, key{0};
+    for (size_t i{0}; i < 5; ++i) {
+        const uint32_t isJoker = withJoker & (ranks[i] == original::joker);
+        jokers += isJoker;
+        for (size_t j{i + 1}; j < 5; ++j) {
+            equalPairs += (ranks[i] == ranks[j]) & !isJoker;
+        }
+        key = (key << 4) | ranks[i];
+    }
+    const uint32_t sumOfSquares = (5 - jokers) + 2 * equalPairs;
+    return (static_cast<uint32_t>(typeTable[signatureIndex(jokers, sumOfSquares)]) << typeShift) | key;
+}
+
+uint32_t handKey(std::string_view cards, bool withJoker) {
+    const auto& table = withJoker ? jokerCardRanks : cardRanks;
+    std::array<uint8_t, 5> ranks;
+    uint8_t invalid{0};
+    for (size_t i{0}; i < 5; ++i) {
+        ranks[i] = table[static_cast<uint8_t>(cards[i])];
+        invalid |= ranks[i];
+    }
+    if (invalid == invalidRank) {
+        throw std::invalid_argument("Invalid card character");
+    }
+    return keyFromRanks(ranks, withJoker);
+}
+
+// Classifies cards.size() / 5 hands stored back to back. Each block of hands is stored
+// card position major, ranks[card][lane], so every step of keyFromRanks runs on one card
+// position across all lanes in the inner loop, which the compiler vectorizes.
+void classifyMany(std::string_view cards, std::span<uint32_t> keys, bool withJoker) {
+    constexpr size_t lanes{32};
+    const auto& table = withJoker ? jokerCardRanks : cardRanks;
+    const size_t handCount = cards.size() / 5;
+    if (keys.size() < handCount) {
+        throw std::invalid_argument("key buffer too small");
+    }
+
+    // lanes past the end of a partial block keep stale ranks, their keys are not stored
+    std::array<std::array<uint8_t, lanes>, 5> ranks{};
+    for (size_t first{0}; first < handCount; first += lanes) {
+        const size_t count = std::min(lanes, handCount - first);
+        const char* block = cards.data() + 5 * first;
+        uint8_t invalid{0};
+        for (size_t lane{0}; lane < count; ++lane) {
+            for (size_t i{0}; i < 5; ++i) {
+                ranks[i][lane] = table[static_cast<uint8_t>(block[5 * lane + i])];
+                invalid |= ranks[i][lane];
+            }
+        }
+        if (invalid == invalidRank) {
+            throw std::invalid_argument("Invalid card character");
+        }
+
+        std::array<uint32_t, lanes> jokers{}, equalPairs{}, key{};
+        for (size_t i{0}; i < 5; ++i) {
+            for (size_t lane{0}; lane < lanes; ++lane) {
+                const uint32_t isJoker = withJoker & (ranks[i][lane] == original::joker);
+                jokers[lane] += isJoker;
+                key[lane] = (key[lane] << 4) | ranks[i][lane];
+            }
+            for (size_t j{i + 1}; j < 5; ++j) {
+                for (size_t lane{0}; lane < lanes; ++lane) {
+                    const uint32_t isJoker = withJoker & (ranks[i][lane] == original::joker);
+                    equalPairs[lane] += (ranks[i][lane] == ranks[j][lane]) & !isJoker;
+                }
+            }
+        }
+        for (size_t lane{0}; lane < count; ++lane) {
+            const uint32_t sumOfSquares = (5 - jokers[lane]) + 2 * equalPairs[lane];
+            keys[first + lane] = (static_cast<uint32_t>(typeTable[signatureIndex(jokers[lane], sumOfSquares)]) << typeShift) | key[lane];
+        }
+    }
+}
+
+RankedHand parseHand(std::string_view line, bool withJoker) {
+    uint32_t bid{0};
+    std::string_view bidPart = line.substr(6);
+    auto [ptr, ec] = std::from_chars(bidPart.data(), bidPart.data() + bidPart.size(), bid);
+    if (ec != std::errc()) {
+        throw std::runtime_error("Parsing error");
+    }
+    return RankedHand{handKey(line, withJoker), bid};
+}
+
+// Two stable counting passes over 12-bit digits of the 23-bit keys, buffer is scratch space.
+void radixSort(std::vector<RankedHand>& hands, std::vector<RankedHand>& buffer) {
+    constexpr uint32_t digitBits{12};
+    constexpr uint32_t buckets{1u << digitBits};
+    static_assert(2 * digitBits >= keyBits);
+
+    buffer.resize(hands.size());
+    std::vector<uint32_t> offsets(buckets);
+    for (uint32_t shift : {0u, digitBits}) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (const auto& hand : hands) {
+            ++offsets[(hand.key >> shift) & (buckets - 1)];
+        }
+        uint32_t sum{0};
+        for (auto& offset : offsets) {
+            sum += std::exchange(offset, sum);
+        }
+        for (const auto& hand : hands) {
+            buffer[offsets[(hand.key >> shift) & (buckets - 1)]++] = hand;
+        }
+        hands.swap(buffer);
+    }
+}
+
+uint64_t totalWinnings(const std::vector<RankedHand>& sortedHands) {
+    uint64_t result{0};
+    for (size_t i{0}; i < sortedHands.size(); ++i) {
+        result += (i + 1) * sortedHands[i].bid;
+    }
+    return result;
+}
+
+uint64_t solve(bool withJoker) {
+    std::vector<RankedHand> hands, buffer;
+    hands.reserve(input::inputContent.size());
+    for (std::string_view line : input::inputContent) {
+        hands.push_back(parseHand(line, withJoker));
+    }
+    radixSort(hands, buffer);
+    return totalWinnings(hands);
+}
+
+uint64_t solution_one() {
+    try {
+        return solve(false);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_two() {
+    try {
+        return solve(true);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// ranks 1e7 random hands, radix sort versus std::stable_sort on the same keys; both keep equal
+// keys in input order, so their winnings match exactly
+void benchmark_large() {
+    try {
+        constexpr size_t handCount{10'000'000};
+        constexpr size_t n{5};
+        constexpr std::string_view faces{"23456789TJQKA"};
+
+        std::mt19937 rng{2023};
+        std::string cards(5 * handCount, ' ');
+        for (char& c : cards) {
+            c = faces[rng() % faces.size()];
+        }
+        std::vector<uint32_t> bids(handCount);
+        for (auto& bid : bids) {
+            bid = 1 + rng() % 1000;
+        }
+
+        std::vector<RankedHand> hands(handCount), buffer;
+        std::vector<uint32_t> keys(handCount);
+        uint64_t radixResult{0}, sortResult{0};
+        std::cout << "1e7 hands, classifier:\n";
+        utils::benchmark<n>([&]() { classifyMany(cards, keys, true); });
+        std::cout << "1e7 hands, radix sort:\n";
+        utils::benchmark<n>([&]() {
+            classifyMany(cards, keys, true);
+            for (size_t i{0}; i < handCount; ++i) {
+                hands[i] = RankedHand{keys[i], bids[i]};
+            }
+            radixSort(hands, buffer);
+            radixResult = totalWinnings(hands);
+        });
+        std::cout << "1e7 hands, std::stable_sort:\n";
+        utils::benchmark<n>([&]() {
+            for (size_t i{0}; i < handCount; ++i) {
+                hands[i] = RankedHand{handKey(std::string_view{cards}.substr(5 * i, 5), true), bids[i]};
+            }
+            std::stable_sort(hands.begin(), hands.end(), [](const RankedHand& a, const RankedHand& b) { return a.key < b.key; });
+            sortResult = totalWinnings(hands);
+        });
+        if (radixResult != sortResult) {
+            throw std::logic_error("radix sort and std::stable_sort rank hands differently");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
@@ -267,5 +560,13 @@ int main() {
     std::cout << "Part 2: " << original::solution_two() << std::endl;
     utils::benchmark<n>(original::solution_two);
 
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    optimized::benchmark_large();
+
     return 0;
 }
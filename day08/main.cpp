@@ -1,4 +1,7 @@
+#include <optional>
+#include <random>
 #include <unordered_map>
+#include <utility>
 
 #include "FileData.hpp"
 #include "utils.hpp"
@@ -135,6 +138,597 @@ uint64_t solution_two() {
 }
 }  // namespace original
 
+namespace optimized {
+
+// Node names are three letters A-Z, read as a base-26 number they give a dense 15-bit id.
+constexpr size_t nameCount{26 * 26 * 26};
+
+uint16_t nodeId(std::string_view name) {
+    uint16_t id{0};
+    for (char c : name.substr(0, 3)) {
+        if (c < 'A' or c > 'Z') {
+            throw std::invalid_argument("node names must consist of the letters A-Z");
+        }
+        id = static_cast<uint16_t>(id * 26 + (c - 'A'));
+    }
+    return id;
+}
+
+constexpr bool endsWith(uint16_t id, char letter) {
+    return id % 26 == static_cast<uint16_t>(letter - 'A');
+}
+
+// Id is uint16_t for the puzzle, generated networks larger than the name space use uint32_t.
+template <typename Id>
+struct Network {
+    std::vector<Id> next;                   // next[2 * node] is the left, next[2 * node + 1] the right neighbour
+    std::vector<Id> nodes;                  // ids that are actually listed
+    std::vector<uint8_t> isGoal;            // node ends in 'Z'
+    std::vector<Id> startNodes;             // nodes ending in 'A'
+    std::vector<uint64_t> instructionBits;  // bit i is set if instruction i is 'R'
+    size_t instructionCount{0};
+
+    [[nodiscard]] size_t nodeCount() const {
+        return isGoal.size();
+    }
+
+    [[nodiscard]] bool goesRight(size_t instruction) const {
+        return (instructionBits[instruction >> 6] >> (instruction & 63)) & 1;
+    }
+
+    [[nodiscard]] Id step(Id node, size_t instruction) const {
+        return next[2 * static_cast<size_t>(node) + goesRight(instruction)];
+    }
+};
+
+template <typename Id>
+void decodeInstructions(std::string_view line, Network<Id>& network) {
+    network.instructionCount = line.size();
+    network.instructionBits.assign((line.size() + 63) / 64, 0);
+    for (size_t i{0}; i < line.size(); ++i) {
+        if (line[i] == 'R') {
+            network.instructionBits[i >> 6] |= uint64_t{1} << (i & 63);
+        } else if (line[i] != 'L') {
+            throw std::invalid_argument("instructions must be L or R");
+        }
+    }
+    if (network.instructionCount == 0) {
+        throw std::invalid_argument("no instructions");
+    }
+}
+
+Network<uint16_t> parseNetwork() {
+    Network<uint16_t> network;
+    decodeInstructions(input::inputContent[0], network);
+
+    // unlisted names loop onto themselves and are never goals
+    network.next.resize(2 * nameCount);
+    for (size_t id{0}; id < nameCount; ++id) {
+        network.next[2 * id] = network.next[2 * id + 1] = static_cast<uint16_t>(id);
+    }
+    network.isGoal.assign(nameCount, 0);
+
+    for (auto it = input::inputContent.begin() + 2; it != input::inputContent.end(); ++it) {
+        std::string_view line{*it};
+        if (line.size() < 15) {
+            throw std::invalid_argument("could not parse node");
+        }
+        const uint16_t id = nodeId(line.substr(0, 3));
+        network.next[2 * id] = nodeId(line.substr(7, 3));
+        network.next[2 * id + 1] = nodeId(line.substr(12, 3));
+        network.nodes.push_back(id);
+        network.isGoal[id] = endsWith(id, 'Z');
+        if (endsWith(id, 'A')) {
+            network.startNodes.push_back(id);
+        }
+    }
+    return network;
+}
+
+// Random network, every node gets two random neighbours and about one in goalEvery is a goal.
+Network<uint32_t> generateNetwork(size_t nodeCount, size_t instructionCount, uint64_t seed, size_t goalEvery = 26) {
+    std::mt19937_64 rng{seed};
+    Network<uint32_t> network;
+
+    std::string instructions(instructionCount, 'L');
+    for (char& c : instructions) {
+        c = (rng() & 1) ? 'R' : 'L';
+    }
+    decodeInstructions(instructions, network);
+
+    network.next.resize(2 * nodeCount);
+    for (auto& neighbour : network.next) {
+        neighbour = static_cast<uint32_t>(rng() % nodeCount);
+    }
+    network.isGoal.resize(nodeCount);
+    for (size_t node{0}; node < nodeCount; ++node) {
+        network.nodes.push_back(static_cast<uint32_t>(node));
+        network.isGoal[node] = rng() % goalEvery == 0;
+        if (rng() % 26 == 0) {
+            network.startNodes.push_back(static_cast<uint32_t>(node));
+        }
+    }
+    return network;
+}
+
+// Jump tables over whole instruction blocks: a block is one pass over all instructions,
+// so every block starts at instruction 0 and only depends on the node it starts at.
+// jump_[k][node] is the node reached after 2^k blocks, bit k of hitLevels_[node] tells
+// whether a goal is hit anywhere within those 2^k blocks.
+template <typename Id>
+class BlockJumper {
+   public:
+    BlockJumper(const Network<Id>& network, std::vector<uint8_t> isGoal)
+        : network_(network), isGoal_(std::move(isGoal)) {
+        const size_t nodeCount{network.nodeCount()};
+        size_t levels{1};
+        while ((size_t{1} << (levels - 1)) <= network.nodes.size()) {
+            ++levels;
+        }
+
+        jump_.assign(levels, std::vector<Id>(nodeCount));
+        hitLevels_.assign(nodeCount, 0);
+        firstHit_.assign(nodeCount, 0);
+        goalAt_.resize(nodeCount);
+        for (size_t node{0}; node < nodeCount; ++node) {
+            jump_[0][node] = static_cast<Id>(node);
+        }
+
+        for (Id node : network.nodes) {
+            Id current{node};
+            for (size_t i{0}; i < network.instructionCount; ++i) {
+                current = network.step(current, i);
+                if (firstHit_[node] == 0 and isGoal_[current]) {
+                    firstHit_[node] = i + 1;
+                    goalAt_[node] = current;
+                }
+            }
+            jump_[0][node] = current;
+            hitLevels_[node] = firstHit_[node] != 0;
+        }
+
+        for (size_t k{1}; k < levels; ++k) {
+            for (size_t node{0}; node < nodeCount; ++node) {
+                const Id half = jump_[k - 1][node];
+                jump_[k][node] = jump_[k - 1][half];
+                const uint64_t hit = ((hitLevels_[node] | hitLevels_[half]) >> (k - 1)) & 1;
+                hitLevels_[node] |= hit << k;
+            }
+        }
+    }
+
+    // Steps until the first goal strictly after standing on node before the given
+    // instruction, and the goal reached. Throws if no goal is ever reached.
+    [[nodiscard]] std::pair<uint64_t, Id> nextGoal(Id node, size_t instruction) const {
+        uint64_t steps{0};
+        // finish the current block one step at a time
+        while (instruction != 0) {
+            node = network_.step(node, instruction);
+            ++steps;
+            if (++instruction == network_.instructionCount) {
+                instruction = 0;
+            }
+            if (isGoal_[node]) {
+                return {steps, node};
+            }
+        }
+
+        // skip as many whole blocks without a goal as possible
+        for (size_t k{jump_.size()}; k-- > 0;) {
+            if (!((hitLevels_[node] >> k) & 1)) {
+                node = jump_[k][node];
+                steps += static_cast<uint64_t>(network_.instructionCount) << k;
+            }
+        }
+        if (firstHit_[node] == 0) {
+            throw std::runtime_error("no goal is reachable");
+        }
+        return {steps + firstHit_[node], goalAt_[node]};
+    }
+
+   private:
+    const Network<Id>& network_;
+    std::vector<uint8_t> isGoal_;
+    std::vector<std::vector<Id>> jump_;
+    std::vector<uint64_t> hitLevels_;
+    std::vector<uint32_t> firstHit_;  // offset 1..instructionCount of the first goal in the block, 0 if none
+    std::vector<Id> goalAt_;
+};
+
+// steps from the first goal the ghost reaches until it stands on that goal again
+template <typename Id>
+uint64_t cycle(Id start, const Network<Id>& network, const BlockJumper<Id>& jumper) {
+    const auto [firstSteps, goal] = jumper.nextGoal(start, 0);
+    size_t instruction = firstSteps % network.instructionCount;
+    uint64_t steps{0};
+    Id current{goal};
+    for (size_t hits{0}; hits <= network.nodeCount() * network.instructionCount; ++hits) {
+        const auto [delta, reached] = jumper.nextGoal(current, instruction);
+        steps += delta;
+        instruction = (instruction + delta) % network.instructionCount;
+        current = reached;
+        if (current == goal) {
+            return steps;
+        }
+    }
+    throw std::runtime_error("ghost never returns to its first goal");
+}
+
+uint64_t solution_one() {
+    try {
+        const Network<uint16_t> network{parseNetwork()};
+        std::vector<uint8_t> isGoal(network.nodeCount(), 0);
+        isGoal[nodeId("ZZZ")] = 1;
+        const BlockJumper<uint16_t> jumper{network, std::move(isGoal)};
+        return jumper.nextGoal(nodeId("AAA"), 0).first;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+using utils::int128_t;
+using utils::uint128_t;
+
+uint128_t gcd(uint128_t a, uint128_t b) {
+    while (b != 0) {
+        a = std::exchange(b, a % b);
+    }
+    return a;
+}
+
+// inverse of a modulo m for coprime a and m < 2^64
+uint128_t inverse(uint128_t a, uint128_t m) {
+    int128_t oldR = static_cast<int128_t>(a % m), r = static_cast<int128_t>(m);
+    int128_t oldS = 1, s = 0;
+    while (r != 0) {
+        const int128_t q = oldR / r;
+        oldR = std::exchange(r, oldR - q * r);
+        oldS = std::exchange(s, oldS - q * s);
+    }
+    oldS %= static_cast<int128_t>(m);
+    return static_cast<uint128_t>(oldS < 0 ? oldS + static_cast<int128_t>(m) : oldS);
+}
+
+struct Congruence {
+    uint128_t residue;
+    uint128_t modulus;
+};
+
+// Generalized CRT: the solutions of x = a.residue (mod a.modulus) and x = residue (mod modulus),
+// modulus has to fit into 64 bits, the combined modulus into 128 bits.
+std::optional<Congruence> merge(const Congruence& a, uint64_t residue, uint64_t modulus) {
+    const uint128_t g = gcd(a.modulus, modulus);
+    const uint128_t difference = (residue + modulus - a.residue % modulus) % modulus;
+    if (difference % g != 0) {
+        return std::nullopt;
+    }
+    const uint128_t reduced = modulus / g;
+    const uint128_t k = (difference / g) % reduced * inverse(a.modulus / g, reduced) % reduced;
+    uint128_t combined;
+    if (__builtin_mul_overflow(a.modulus, reduced, &combined)) {
+        throw std::overflow_error("common period does not fit into 128 bits");
+    }
+    return Congruence{a.residue + a.modulus * k, combined};
+}
+
+// Where a ghost stands is fully determined by (node, instruction index), so its walk is a tail
+// of tailLength states followed by a cycle of cycleLength states. Goals seen in the tail happen
+// once, goals seen in the cycle repeat every cycleLength steps.
+struct GhostCycle {
+    uint64_t tailLength{0};
+    uint64_t cycleLength{0};
+    std::vector<uint64_t> tailHits;   // goal times in [1, tailLength)
+    std::vector<uint64_t> cycleHits;  // goal times in [tailLength, tailLength + cycleLength)
+
+    [[nodiscard]] bool onGoalAt(uint64_t time) const {
+        if (time < tailLength) {
+            return std::binary_search(tailHits.begin(), tailHits.end(), time);
+        }
+        const uint64_t phase = tailLength + (time - tailLength) % cycleLength;
+        return std::binary_search(cycleHits.begin(), cycleHits.end(), phase);
+    }
+};
+
+template <typename Id>
+GhostCycle analyzeGhost(Id start, const Network<Id>& network) {
+    struct State {
+        Id node;
+        size_t instruction;
+        bool operator==(const State&) const = default;
+    };
+    auto advance = [&](State state) {
+        const size_t next = state.instruction + 1 == network.instructionCount ? 0 : state.instruction + 1;
+        return State{network.step(state.node, state.instruction), next};
+    };
+    const State origin{start, 0};
+
+    // Brent: find the cycle length by teleporting the tortoise at powers of two
+    GhostCycle ghost;
+    uint64_t power{1}, length{1};
+    State tortoise{origin}, hare{advance(origin)};
+    while (!(tortoise == hare)) {
+        if (power == length) {
+            tortoise = hare;
+            power *= 2;
+            length = 0;
+        }
+        hare = advance(hare);
+        ++length;
+    }
+    ghost.cycleLength = length;
+
+    // a hare one cycle ahead meets the tortoise where the cycle starts
+    tortoise = hare = origin;
+    for (uint64_t i{0}; i < length; ++i) {
+        hare = advance(hare);
+    }
+    while (!(tortoise == hare)) {
+        tortoise = advance(tortoise);
+        hare = advance(hare);
+        ++ghost.tailLength;
+    }
+
+    State state{origin};
+    for (uint64_t time{0}; time < ghost.tailLength + ghost.cycleLength; ++time) {
+        if (network.isGoal[state.node]) {
+            if (time >= ghost.tailLength) {
+                ghost.cycleHits.push_back(time);
+            } else if (time > 0) {
+                ghost.tailHits.push_back(time);
+            }
+        }
+        state = advance(state);
+    }
+    return ghost;
+}
+
+// First time t >= 1 at which every ghost stands on a goal, if there is one.
+std::optional<uint128_t> firstCommonGoal(const std::vector<GhostCycle>& ghosts) {
+    constexpr size_t maxCombinations{1'000'000};
+    if (ghosts.empty()) {
+        throw std::invalid_argument("no ghosts");
+    }
+
+    // before every ghost is in its cycle, try the times the first ghost is on a goal
+    uint64_t periodicFrom{1};
+    for (const auto& ghost : ghosts) {
+        periodicFrom = std::max(periodicFrom, ghost.tailLength);
+    }
+    auto allOnGoal = [&](uint64_t time) {
+        return std::all_of(ghosts.begin(), ghosts.end(), [time](const GhostCycle& ghost) { return ghost.onGoalAt(time); });
+    };
+    const GhostCycle& first{ghosts.front()};
+    for (uint64_t time : first.tailHits) {
+        if (allOnGoal(time)) {
+            return time;
+        }
+    }
+    for (uint64_t base{0}; !first.cycleHits.empty() and first.cycleHits.front() + base < periodicFrom; base += first.cycleLength) {
+        for (uint64_t hit : first.cycleHits) {
+            if (hit + base >= 1 and hit + base < periodicFrom and allOnGoal(hit + base)) {
+                return hit + base;
+            }
+        }
+    }
+
+    // afterwards every ghost is periodic, combine the residues of all ghosts
+    std::vector<Congruence> combined{Congruence{0, 1}}, next;
+    for (const auto& ghost : ghosts) {
+        std::vector<uint64_t> residues;
+        for (uint64_t hit : ghost.cycleHits) {
+            residues.push_back(hit % ghost.cycleLength);
+        }
+        // every pair may merge, so bound the product before building it
+        if (!residues.empty() and combined.size() > maxCombinations / residues.size()) {
+            throw std::runtime_error("too many goal phase combinations");
+        }
+        next.clear();
+        for (const auto& congruence : combined) {
+            for (uint64_t residue : residues) {
+                if (auto merged = merge(congruence, residue, ghost.cycleLength)) {
+                    next.push_back(*merged);
+                }
+            }
+        }
+        std::swap(combined, next);
+    }
+
+    std::optional<uint128_t> best;
+    for (const auto& [residue, modulus] : combined) {
+        const uint128_t start = periodicFrom % modulus;
+        const uint128_t offset = residue >= start ? residue - start : residue + (modulus - start);
+        uint128_t time;
+        if (__builtin_add_overflow(static_cast<uint128_t>(periodicFrom), offset, &time)) {
+            continue;
+        }
+        if (!best or time < *best) {
+            best = time;
+        }
+    }
+    return best;
+}
+
+template <typename Id>
+std::optional<uint128_t> ghostsMeet(const Network<Id>& network, const std::vector<Id>& starts) {
+    std::vector<GhostCycle> ghosts(starts.size());
+    utils::defaultPool().parallelFor(starts.size(), [&](size_t i) {
+        ghosts[i] = analyzeGhost(starts[i], network);
+    });
+    return firstCommonGoal(ghosts);
+}
+
+uint64_t solution_two() {
+    try {
+        const Network<uint16_t> network{parseNetwork()};
+        const auto steps = ghostsMeet(network, network.startNodes);
+        if (!steps) {
+            throw std::runtime_error("the ghosts never all stand on a goal");
+        }
+        if (*steps > std::numeric_limits<uint64_t>::max()) {
+            throw std::overflow_error("result does not fit into 64 bits");
+        }
+        return static_cast<uint64_t>(*steps);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// lcm of the ghost cycles, only right when every ghost first reaches a goal after exactly one cycle
+uint64_t solution_two_lcm() {
+    try {
+        const Network<uint16_t> network{parseNetwork()};
+        const BlockJumper<uint16_t> jumper{network, network.isGoal};
+        std::vector<size_t> cycles;
+        for (uint16_t start : network.startNodes) {
+            cycles.push_back(cycle(start, network, jumper));
+        }
+        return original::lcm(cycles);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// walks 1e8 steps through a generated network with 2^17 nodes
+void benchmark_steps() {
+    try {
+        constexpr size_t nodeCount{1 << 17};
+        constexpr size_t stepCount{100'000'000};
+        constexpr size_t n{5};
+
+        const Network<uint32_t> network{generateNetwork(nodeCount, 293, 2023)};
+        uint64_t goalHits{0};
+        std::cout << "1e8 steps on a " << nodeCount << " node network:\n";
+        utils::benchmark<n>([&]() {
+            uint32_t current{0};
+            size_t i{0};
+            goalHits = 0;
+            for (size_t step{0}; step < stepCount; ++step) {
+                current = network.step(current, i);
+                if (++i == network.instructionCount) {
+                    i = 0;
+                }
+                goalHits += network.isGoal[current];
+            }
+        });
+        std::cout << "Goal hits: " << goalHits << '\n';
+
+        // first hit of a rare goal from every start, block jumps versus single steps
+        std::vector<uint8_t> rareGoal(nodeCount, 0);
+        for (size_t node{0}; node < nodeCount; node += 4096) {
+            rareGoal[node] = 1;
+        }
+        std::cout << "Building block jump tables:\n";
+        utils::benchmark<1>([&]() { BlockJumper<uint32_t>{network, rareGoal}; });
+        const BlockJumper<uint32_t> jumper{network, rareGoal};
+
+        std::vector<uint64_t> jumped(network.startNodes.size(), 0), walked(network.startNodes.size(), 0);
+        std::cout << "First rare goal from " << network.startNodes.size() << " starts, block jumps:\n";
+        utils::benchmark<n>([&]() {
+            for (size_t s{0}; s < network.startNodes.size(); ++s) {
+                try {
+                    jumped[s] = jumper.nextGoal(network.startNodes[s], 0).first;
+                } catch (const std::runtime_error&) {
+                    jumped[s] = 0;  // unreachable
+                }
+            }
+        });
+        std::cout << "First rare goal from " << network.startNodes.size() << " starts, single steps:\n";
+        utils::benchmark<n>([&]() {
+            for (size_t s{0}; s < network.startNodes.size(); ++s) {
+                if (jumped[s] == 0) {
+                    continue;
+                }
+                uint32_t current{network.startNodes[s]};
+                size_t i{0};
+                uint64_t steps{0};
+                do {
+                    current = network.step(current, i);
+                    if (++i == network.instructionCount) {
+                        i = 0;
+                    }
+                    ++steps;
+                } while (!rareGoal[current]);
+                walked[s] = steps;
+            }
+        });
+        if (jumped != walked) {
+            throw std::logic_error("block jumps and single steps disagree");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// One ring per ghost: the start runs down a random tail into its ring, which holds a single goal at
+// a random position. The first goal then comes after a different number of steps than the cycle.
+Network<uint32_t> generateGhostRings(const std::vector<uint32_t>& ringLengths, uint64_t seed) {
+    std::mt19937_64 rng{seed};
+    Network<uint32_t> network;
+    decodeInstructions("LRRLRLL", network);
+
+    auto addNode = [&network]() {
+        const auto id = static_cast<uint32_t>(network.isGoal.size());
+        network.nodes.push_back(id);
+        network.isGoal.push_back(0);
+        network.next.push_back(id);
+        network.next.push_back(id);
+        return id;
+    };
+    auto link = [&network](uint32_t from, uint32_t to) {
+        network.next[2 * from] = network.next[2 * from + 1] = to;
+    };
+
+    for (uint32_t ringLength : ringLengths) {
+        uint32_t current{addNode()};
+        network.startNodes.push_back(current);
+        for (uint64_t tail{rng() % ringLength}; tail > 0; --tail) {
+            const uint32_t next{addNode()};
+            link(current, next);
+            current = next;
+        }
+        const uint32_t ringStart{addNode()};
+        link(current, ringStart);
+        current = ringStart;
+        for (uint32_t i{1}; i < ringLength; ++i) {
+            const uint32_t next{addNode()};
+            link(current, next);
+            current = next;
+        }
+        link(current, ringStart);
+        network.isGoal[ringStart + rng() % ringLength] = 1;
+    }
+    return network;
+}
+
+// six ghosts on rings of about 2e4 nodes each, the answer needs more than 64 bits
+void benchmark_ghosts() {
+    try {
+        constexpr size_t n{5};
+        const Network<uint32_t> network{generateGhostRings({19'997, 20'011, 20'021, 20'023, 20'029, 20'047}, 2023)};
+
+        std::optional<uint128_t> steps;
+        std::cout << "Ghosts on a generated network with " << network.nodeCount() << " nodes:\n";
+        utils::benchmark<n>([&]() { steps = ghostsMeet(network, network.startNodes); });
+        std::cout << "Steps: " << (steps ? utils::toString(*steps) : "never") << '\n';
+
+        const BlockJumper<uint32_t> jumper{network, network.isGoal};
+        uint128_t shortcut{1};
+        for (uint32_t start : network.startNodes) {
+            const uint128_t length{cycle(start, network, jumper)};
+            shortcut = shortcut / gcd(shortcut, length) * length;
+        }
+        std::cout << "lcm shortcut would claim: " << utils::toString(shortcut) << '\n';
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
@@ -144,5 +738,17 @@ int main() {
     std::cout << "Part 2: " << original::solution_two() << std::endl;
     utils::benchmark<n>(original::solution_two);
 
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    std::cout << "Part 2 (lcm shortcut): " << optimized::solution_two_lcm() << std::endl;
+    utils::benchmark<n>(optimized::solution_two_lcm);
+
+    optimized::benchmark_steps();
+    optimized::benchmark_ghosts();
+
     return 0;
 }
@@ -1,3 +1,12 @@
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include <bit>
+#include <charconv>
+#include <random>
+#include <span>
+
 #include "FileData.hpp"
 #include "utils.hpp"
 
@@ -102,6 +111,387 @@ int64_t solution_two() {
 }
 }  // namespace original
 
+namespace optimized {
+
+constexpr size_t MAX_SEQ_LENGTH{128};
+
+using Sequence = std::array<int64_t, MAX_SEQ_LENGTH>;
+
+// Parses the signed numbers of a line into buffer and returns how many there are.
+size_t parseSequence(std::string_view line, Sequence& buffer) {
+    size_t length{0};
+    const char* head = line.data();
+    const char* end = line.data() + line.size();
+    while (head != end) {
+        if (*head == ' ') {
+            ++head;
+            continue;
+        }
+        if (length == MAX_SEQ_LENGTH) {
+            throw std::length_error("sequence longer than MAX_SEQ_LENGTH");
+        }
+        auto [ptr, ec] = std::from_chars(head, end, buffer[length++]);
+        if (ec != std::errc()) {
+            throw std::runtime_error("Parsing error occurred");
+        }
+        head = ptr;
+    }
+    return length;
+}
+
+// values[i] = values[i + 1] - values[i] for the first length - 1 entries
+inline void differenceInPlace(int64_t* values, size_t length) {
+    size_t i{0};
+#ifdef __AVX2__
+    // ascending order only reads entries that have not been overwritten yet
+    for (; i + 4 < length; i += 4) {
+        const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        const __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), _mm256_sub_epi64(next, current));
+    }
+#endif
+    for (; i + 1 < length; ++i) {
+        values[i] = values[i + 1] - values[i];
+    }
+}
+
+inline bool allZero(const int64_t* values, size_t length) {
+    int64_t bits{0};
+    for (size_t i{0}; i < length; ++i) {
+        bits |= values[i];
+    }
+    return bits == 0;
+}
+
+struct Extrapolation {
+    int64_t forward;
+    int64_t backward;
+};
+
+// Reduces the difference table in place, one level at a time. The next value is the sum
+// of the last entries of all levels, the previous value the alternating sum of the first ones.
+Extrapolation extrapolate(int64_t* values, size_t length) {
+    Extrapolation result{0, 0};
+    int64_t sign{1};
+    while (length > 0) {
+        result.forward += values[length - 1];
+        result.backward += sign * values[0];
+        sign = -sign;
+        if (allZero(values, length)) {
+            break;
+        }
+        differenceInPlace(values, length--);
+    }
+    return result;
+}
+
+Extrapolation solve() {
+    Extrapolation total{0, 0};
+    Sequence buffer;
+    for (std::string_view line : input::inputContent) {
+        const Extrapolation result = extrapolate(buffer.data(), parseSequence(line, buffer));
+        total.forward += result.forward;
+        total.backward += result.backward;
+    }
+    return total;
+}
+
+int64_t solution_one() {
+    try {
+        return solve().forward;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+int64_t solution_two() {
+    try {
+        return solve().backward;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// Closed form: for a sequence a_0..a_{n-1} the difference table extrapolates the polynomial of
+// degree n - 1 through it, so
+//   next     = sum_i (-1)^(n-1-i) * C(n, i)     * a_i
+//   previous = sum_i (-1)^i       * C(n, i + 1) * a_i
+using utils::int128_t;
+
+// C(N, 0) .. C(N, N)
+template <size_t N>
+constexpr std::array<int64_t, N + 1> binomialRow() {
+    std::array<int64_t, N + 1> row{};
+    row[0] = 1;
+    for (size_t n{1}; n <= N; ++n) {
+        for (size_t k{n}; k > 0; --k) {
+            row[k] += row[k - 1];
+        }
+    }
+    return row;
+}
+
+template <size_t N>
+constexpr std::array<int64_t, N> forwardCoefficients() {
+    constexpr auto row{binomialRow<N>()};
+    std::array<int64_t, N> coefficients{};
+    for (size_t i{0}; i < N; ++i) {
+        coefficients[i] = ((N - 1 - i) % 2 == 0 ? 1 : -1) * row[i];
+    }
+    return coefficients;
+}
+
+template <size_t N>
+constexpr std::array<int64_t, N> backwardCoefficients() {
+    constexpr auto row{binomialRow<N>()};
+    std::array<int64_t, N> coefficients{};
+    for (size_t i{0}; i < N; ++i) {
+        coefficients[i] = (i % 2 == 0 ? 1 : -1) * row[i + 1];
+    }
+    return coefficients;
+}
+
+static_assert(forwardCoefficients<3>() == std::array<int64_t, 3>{1, -3, 3});
+static_assert(backwardCoefficients<3>() == std::array<int64_t, 3>{3, -3, 1});
+
+// coefficients for any length up to MAX_SEQ_LENGTH, C(128, 64) still fits into 128 bits
+struct Coefficients {
+    std::vector<int128_t> forward;
+    std::vector<int128_t> backward;
+};
+
+Coefficients coefficientsFor(size_t length) {
+    std::vector<int128_t> row(length + 1, 0);
+    row[0] = 1;
+    for (size_t n{1}; n <= length; ++n) {
+        for (size_t k{n}; k > 0; --k) {
+            row[k] += row[k - 1];
+        }
+    }
+    Coefficients coefficients;
+    for (size_t i{0}; i < length; ++i) {
+        coefficients.forward.push_back(((length - 1 - i) % 2 == 0 ? 1 : -1) * row[i]);
+        coefficients.backward.push_back((i % 2 == 0 ? 1 : -1) * row[i + 1]);
+    }
+    return coefficients;
+}
+
+// Sequences of one length, stored column major: values[i * count + s] is element i of sequence s.
+struct SequenceBatch {
+    size_t length{0};
+    size_t count{0};
+    std::vector<int64_t> values;
+    uint64_t maxAbs{0};  // |value| in unsigned, so INT64_MIN has one too
+};
+
+// out[s] = sum_i coefficients[i] * values[i * count + s]. Needs every value and coefficient
+// to fit into 32 bits and the sums to fit into 64, then AVX2 does four sequences at a time.
+void dotColumns(const SequenceBatch& batch, const int64_t* coefficients, std::span<int64_t> out) {
+    const size_t count{batch.count};
+    const int64_t* values{batch.values.data()};
+    size_t s{0};
+#ifdef __AVX2__
+    for (; s + 4 <= count; s += 4) {
+        __m256i accumulator = _mm256_setzero_si256();
+        for (size_t i{0}; i < batch.length; ++i) {
+            const __m256i column = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i * count + s));
+            accumulator = _mm256_add_epi64(accumulator, _mm256_mul_epi32(column, _mm256_set1_epi64x(coefficients[i])));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.data() + s), accumulator);
+    }
+#endif
+    for (; s < count; ++s) {
+        int64_t sum{0};
+        for (size_t i{0}; i < batch.length; ++i) {
+            sum += coefficients[i] * values[i * count + s];
+        }
+        out[s] = sum;
+    }
+}
+
+// fallback for long sequences or large values, every step is overflow checked
+void dotColumnsChecked(const SequenceBatch& batch, const std::vector<int128_t>& coefficients, std::span<int64_t> out) {
+    for (size_t s{0}; s < batch.count; ++s) {
+        int128_t sum{0};
+        for (size_t i{0}; i < batch.length; ++i) {
+            int128_t product;
+            if (__builtin_mul_overflow(coefficients[i], static_cast<int128_t>(batch.values[i * batch.count + s]), &product) or
+                __builtin_add_overflow(sum, product, &sum)) {
+                throw std::overflow_error("extrapolation does not fit into 128 bits");
+            }
+        }
+        if (sum > std::numeric_limits<int64_t>::max() or sum < std::numeric_limits<int64_t>::min()) {
+            throw std::overflow_error("extrapolated value does not fit into 64 bits");
+        }
+        out[s] = static_cast<int64_t>(sum);
+    }
+}
+
+template <size_t N>
+constexpr bool fitsInt32(const std::array<int64_t, N>& coefficients) {
+    return std::all_of(coefficients.begin(), coefficients.end(), [](int64_t c) {
+        return c >= std::numeric_limits<int32_t>::min() and c <= std::numeric_limits<int32_t>::max();
+    });
+}
+
+template <size_t N>
+void extrapolateFixed(const SequenceBatch& batch, std::span<int64_t> forward, std::span<int64_t> backward) {
+    static constexpr auto forwardRow{forwardCoefficients<N>()};
+    static constexpr auto backwardRow{backwardCoefficients<N>()};
+    static_assert(fitsInt32(forwardRow) and fitsInt32(backwardRow));
+    dotColumns(batch, forwardRow.data(), forward);
+    dotColumns(batch, backwardRow.data(), backward);
+}
+
+void extrapolateBatch(const SequenceBatch& batch, std::span<int64_t> forward, std::span<int64_t> backward) {
+    if (forward.size() < batch.count or backward.size() < batch.count) {
+        throw std::invalid_argument("output spans too small");
+    }
+    // sum_i |c_i| = 2^n - 1, so the 64-bit sums are safe while 2^n * max|a_i| < 2^63
+    const bool small = batch.maxAbs <= static_cast<uint64_t>(std::numeric_limits<int32_t>::max()) and
+                       batch.length + std::bit_width(batch.maxAbs) <= 62;
+    if (small and batch.length == 6) {
+        extrapolateFixed<6>(batch, forward, backward);
+    } else if (small and batch.length == 21) {
+        extrapolateFixed<21>(batch, forward, backward);
+    } else {
+        const Coefficients coefficients{coefficientsFor(batch.length)};
+        dotColumnsChecked(batch, coefficients.forward, forward);
+        dotColumnsChecked(batch, coefficients.backward, backward);
+    }
+}
+
+// groups the sequences by length into column major batches
+std::vector<SequenceBatch> buildBatches(const std::vector<std::pair<const int64_t*, size_t>>& sequences) {
+    std::vector<SequenceBatch> batches(MAX_SEQ_LENGTH + 1);
+    for (const auto& [values, length] : sequences) {
+        ++batches[length].count;
+    }
+    std::vector<size_t> filled(MAX_SEQ_LENGTH + 1, 0);
+    for (size_t length{0}; length <= MAX_SEQ_LENGTH; ++length) {
+        batches[length].length = length;
+        batches[length].values.resize(length * batches[length].count);
+    }
+    for (const auto& [values, length] : sequences) {
+        SequenceBatch& batch{batches[length]};
+        const size_t s{filled[length]++};
+        for (size_t i{0}; i < length; ++i) {
+            batch.values[i * batch.count + s] = values[i];
+            const uint64_t magnitude{static_cast<uint64_t>(values[i])};
+            batch.maxAbs = std::max(batch.maxAbs, values[i] < 0 ? 0 - magnitude : magnitude);
+        }
+    }
+    std::erase_if(batches, [](const SequenceBatch& batch) { return batch.count == 0; });
+    return batches;
+}
+
+Extrapolation solveClosedForm() {
+    std::vector<int64_t> storage(input::inputContent.size() * MAX_SEQ_LENGTH);
+    std::vector<std::pair<const int64_t*, size_t>> sequences;
+    Sequence buffer;
+    for (size_t line{0}; line < input::inputContent.size(); ++line) {
+        const size_t length = parseSequence(input::inputContent[line], buffer);
+        int64_t* slot = storage.data() + line * MAX_SEQ_LENGTH;
+        std::copy_n(buffer.begin(), length, slot);
+        sequences.emplace_back(slot, length);
+    }
+
+    Extrapolation total{0, 0};
+    std::vector<int64_t> forward, backward;
+    for (const auto& batch : buildBatches(sequences)) {
+        forward.resize(batch.count);
+        backward.resize(batch.count);
+        extrapolateBatch(batch, forward, backward);
+        for (size_t s{0}; s < batch.count; ++s) {
+            total.forward += forward[s];
+            total.backward += backward[s];
+        }
+    }
+    return total;
+}
+
+int64_t solution_one_closed_form() {
+    try {
+        return solveClosedForm().forward;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+int64_t solution_two_closed_form() {
+    try {
+        return solveClosedForm().backward;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// 1e6 generated length 21 sequences (polynomials of degree <= 6), difference table versus closed form
+void benchmark_generated() {
+    try {
+        constexpr size_t sequenceCount{1'000'000};
+        constexpr size_t length{21};
+        constexpr size_t n{10};
+
+        std::mt19937_64 rng{2023};
+        std::vector<int64_t> storage(sequenceCount * length);
+        std::vector<std::pair<const int64_t*, size_t>> sequences;
+        for (size_t s{0}; s < sequenceCount; ++s) {
+            std::array<int64_t, 7> polynomial{};
+            const size_t degree = rng() % polynomial.size();
+            for (size_t d{0}; d <= degree; ++d) {
+                polynomial[d] = static_cast<int64_t>(rng() % 7) - 3;
+            }
+            for (size_t i{0}; i < length; ++i) {
+                int64_t value{0};
+                for (size_t d{degree + 1}; d-- > 0;) {
+                    value = value * static_cast<int64_t>(i) + polynomial[d];
+                }
+                storage[s * length + i] = value;
+            }
+            sequences.emplace_back(storage.data() + s * length, length);
+        }
+
+        Extrapolation table{0, 0}, closed{0, 0};
+        std::cout << "1e6 sequences, difference table:\n";
+        utils::benchmark<n>([&]() {
+            table = {0, 0};
+            Sequence buffer;
+            for (const auto& [values, count] : sequences) {
+                std::copy_n(values, count, buffer.begin());
+                const Extrapolation result = extrapolate(buffer.data(), count);
+                table.forward += result.forward;
+                table.backward += result.backward;
+            }
+        });
+
+        const auto batches{buildBatches(sequences)};
+        std::vector<int64_t> forward(sequenceCount), backward(sequenceCount);
+        std::cout << "1e6 sequences, closed form:\n";
+        utils::benchmark<n>([&]() {
+            closed = {0, 0};
+            for (const auto& batch : batches) {
+                extrapolateBatch(batch, forward, backward);
+                for (size_t s{0}; s < batch.count; ++s) {
+                    closed.forward += forward[s];
+                    closed.backward += backward[s];
+                }
+            }
+        });
+        if (table.forward != closed.forward or table.backward != closed.backward) {
+            throw std::logic_error("closed form disagrees with the difference table");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
@@ -111,5 +501,20 @@ int main() {
     std::cout << "Part 2: " << original::solution_two() << std::endl;
     utils::benchmark<n>(original::solution_two);
 
+    // utils::extractNumbers skips '-', so the original solutions read negative numbers as positive
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    std::cout << "Part 1 (closed form): " << optimized::solution_one_closed_form() << std::endl;
+    utils::benchmark<n>(optimized::solution_one_closed_form);
+
+    std::cout << "Part 2 (closed form): " << optimized::solution_two_closed_form() << std::endl;
+    utils::benchmark<n>(optimized::solution_two_closed_form);
+
+    optimized::benchmark_generated();
+
     return 0;
 }
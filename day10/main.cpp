@@ -1,3 +1,8 @@
+#ifdef __PCLMUL__
+#include <immintrin.h>
+#endif
+
+#include <bit>
 #include <iomanip>
 #include <optional>
 #include <stack>
@@ -329,6 +334,374 @@ uint64_t solution_two() {
 }
 }  // namespace original
 
+namespace optimized {
+
+// Connectivity of a cell as a 4-bit mask, bit d is set if the pipe opens towards direction d.
+enum Dir : uint8_t { north,
+                     east,
+                     south,
+                     west,
+                     invalid };
+
+constexpr uint8_t bit(uint8_t dir) {
+    return static_cast<uint8_t>(1u << dir);
+}
+
+constexpr uint8_t opposite(uint8_t dir) {
+    return dir ^ 2;
+}
+
+constexpr std::array<int64_t, 4> dx{0, 1, 0, -1};
+constexpr std::array<int64_t, 4> dy{-1, 0, 1, 0};
+
+constexpr std::array<uint8_t, 256> buildCharMasks() {
+    std::array<uint8_t, 256> masks{};
+    masks['|'] = bit(north) | bit(south);
+    masks['-'] = bit(east) | bit(west);
+    masks['L'] = bit(north) | bit(east);
+    masks['J'] = bit(north) | bit(west);
+    masks['7'] = bit(south) | bit(west);
+    masks['F'] = bit(south) | bit(east);
+    return masks;
+}
+
+constexpr std::array<uint8_t, 256> charMasks{buildCharMasks()};
+
+// exitTable[mask][travel] is the direction to leave a cell with that mask after entering
+// it while moving in direction travel, or invalid if the pipe does not take us in.
+constexpr std::array<std::array<uint8_t, 4>, 16> buildExitTable() {
+    std::array<std::array<uint8_t, 4>, 16> table{};
+    for (uint8_t mask{0}; mask < 16; ++mask) {
+        for (uint8_t travel{0}; travel < 4; ++travel) {
+            table[mask][travel] = invalid;
+            const uint8_t entry = bit(opposite(travel));
+            if (std::popcount(mask) != 2 or !(mask & entry)) {
+                continue;
+            }
+            table[mask][travel] = static_cast<uint8_t>(std::countr_zero(static_cast<uint8_t>(mask & ~entry)));
+        }
+    }
+    return table;
+}
+
+constexpr auto exitTable{buildExitTable()};
+static_assert(exitTable[bit(north) | bit(east)][south] == east);
+static_assert(exitTable[bit(north) | bit(south)][east] == invalid);
+
+// Two cells per byte, plus one bit per cell marking the loop and one marking loop cells
+// that open to the north. Rows of both bitsets start on word boundaries so they can be
+// processed independently.
+class PipeGrid {
+   public:
+    size_t width{0};
+    size_t height{0};
+    size_t rowWords{0};
+    size_t startX{0};
+    size_t startY{0};
+
+    template <typename Lines>
+    explicit PipeGrid(const Lines& lines) {
+        for (std::string_view line : lines) {
+            if (line.empty()) {
+                break;
+            }
+            if (height == 0) {
+                width = line.size();
+            } else if (line.size() != width) {
+                throw std::invalid_argument("rows differ in width");
+            }
+            ++height;
+        }
+        rowWords = (width + 63) / 64;
+        cells_.assign((width * height + 1) / 2, 0);
+        loop_.assign(rowWords * height, 0);
+        northLoop_.assign(rowWords * height, 0);
+
+        bool foundStart{false};
+        size_t y{0};
+        for (std::string_view line : lines) {
+            if (y == height) {
+                break;
+            }
+            for (size_t x{0}; x < width; ++x) {
+                if (line[x] == 'S') {
+                    startX = x;
+                    startY = y;
+                    foundStart = true;
+                } else {
+                    setMask(x, y, charMasks[static_cast<uint8_t>(line[x])]);
+                }
+            }
+            ++y;
+        }
+        if (!foundStart) {
+            throw std::invalid_argument("no start tile");
+        }
+
+        // the start connects to the two ends of the pipe that leads around back to it; other
+        // neighbours may point into the start without being on the loop
+        for (uint8_t dir{0}; dir < 4; ++dir) {
+            if (const auto back{closingDirection(dir)}) {
+                setMask(startX, startY, static_cast<uint8_t>(bit(dir) | bit(*back)));
+                return;
+            }
+        }
+        throw std::runtime_error("start tile is not on a closed loop");
+    }
+
+    [[nodiscard]] bool inside(int64_t x, int64_t y) const {
+        return x >= 0 and y >= 0 and static_cast<size_t>(x) < width and static_cast<size_t>(y) < height;
+    }
+
+    [[nodiscard]] uint8_t mask(size_t x, size_t y) const {
+        const size_t index{y * width + x};
+        return (cells_[index >> 1] >> ((index & 1) * 4)) & 0xF;
+    }
+
+    void setMask(size_t x, size_t y, uint8_t value) {
+        const size_t index{y * width + x};
+        const unsigned shift = (index & 1) * 4;
+        cells_[index >> 1] = static_cast<uint8_t>((cells_[index >> 1] & ~(0xF << shift)) | (value << shift));
+    }
+
+    [[nodiscard]] bool onLoop(size_t x, size_t y) const {
+        return (loop_[y * rowWords + x / 64] >> (x % 64)) & 1;
+    }
+
+    void markLoop(size_t x, size_t y) {
+        loop_[y * rowWords + x / 64] |= uint64_t{1} << (x % 64);
+        northLoop_[y * rowWords + x / 64] |= static_cast<uint64_t>((mask(x, y) >> north) & 1) << (x % 64);
+    }
+
+    [[nodiscard]] const uint64_t* loopRow(size_t y) const {
+        return loop_.data() + y * rowWords;
+    }
+
+    [[nodiscard]] const uint64_t* northLoopRow(size_t y) const {
+        return northLoop_.data() + y * rowWords;
+    }
+
+   private:
+    std::vector<uint8_t> cells_;
+    std::vector<uint64_t> loop_;
+    std::vector<uint64_t> northLoop_;
+
+    // Follows the pipe leaving the start towards dir. If it comes back to the start, returns the
+    // direction it arrives from, the start's other connection. Every pipe tile has two ends, so
+    // the walk either breaks off or returns to the start.
+    [[nodiscard]] std::optional<uint8_t> closingDirection(uint8_t dir) const {
+        int64_t x = static_cast<int64_t>(startX);
+        int64_t y = static_cast<int64_t>(startY);
+        while (true) {
+            x += dx[dir];
+            y += dy[dir];
+            if (!inside(x, y)) {
+                return std::nullopt;
+            }
+            if (x == static_cast<int64_t>(startX) and y == static_cast<int64_t>(startY)) {
+                return opposite(dir);
+            }
+            dir = exitTable[mask(static_cast<size_t>(x), static_cast<size_t>(y))][dir];
+            if (dir == invalid) {
+                return std::nullopt;
+            }
+        }
+    }
+};
+
+struct Loop {
+    uint64_t length;
+    int64_t doubledArea;  // shoelace sum over the loop's cell centres
+};
+
+// Follows the pipe from the start until it returns, marking the loop and summing the
+// shoelace formula on the way. Returns nothing if the pipe breaks or leaves the map.
+std::optional<Loop> traceLoop(PipeGrid& grid) {
+    Loop loop{0, 0};
+    int64_t x = static_cast<int64_t>(grid.startX);
+    int64_t y = static_cast<int64_t>(grid.startY);
+    uint8_t dir = static_cast<uint8_t>(std::countr_zero(grid.mask(grid.startX, grid.startY)));
+    do {
+        grid.markLoop(static_cast<size_t>(x), static_cast<size_t>(y));
+        const int64_t nx = x + dx[dir];
+        const int64_t ny = y + dy[dir];
+        if (!grid.inside(nx, ny)) {
+            return std::nullopt;
+        }
+        loop.doubledArea += x * ny - nx * y;
+        ++loop.length;
+        x = nx;
+        y = ny;
+        dir = exitTable[grid.mask(static_cast<size_t>(x), static_cast<size_t>(y))][dir];
+        if (dir == invalid) {
+            return std::nullopt;
+        }
+    } while (x != static_cast<int64_t>(grid.startX) or y != static_cast<int64_t>(grid.startY));
+    return loop;
+}
+
+// Pick's theorem: area = interior + boundary / 2 - 1
+uint64_t interiorPoints(const Loop& loop) {
+    const int64_t area2 = loop.doubledArea < 0 ? -loop.doubledArea : loop.doubledArea;
+    return static_cast<uint64_t>((area2 - static_cast<int64_t>(loop.length)) / 2 + 1);
+}
+
+Loop requireLoop(PipeGrid& grid) {
+    auto loop = traceLoop(grid);
+    if (!loop) {
+        throw std::runtime_error("no closed loop through the start tile");
+    }
+    return *loop;
+}
+
+// Bit i of the result is the xor of bits 0..i, i.e. the carry-less product with all ones.
+inline uint64_t prefixXor(uint64_t bits) {
+#ifdef __PCLMUL__
+    const __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<int64_t>(bits)), _mm_set1_epi64x(-1), 0);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+#else
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+#endif
+}
+
+// A cell off the loop is inside if an odd number of north-opening loop cells lie to its left.
+uint64_t countRowInterior(const PipeGrid& grid, size_t y) {
+    const uint64_t* loop{grid.loopRow(y)};
+    const uint64_t* northLoop{grid.northLoopRow(y)};
+    uint64_t count{0};
+    uint64_t parity{0};  // all ones while an odd number of crossings lies to the left
+    for (size_t word{0}; word < grid.rowWords; ++word) {
+        const uint64_t inside = prefixXor(northLoop[word]) ^ parity;
+        count += std::popcount(inside & ~loop[word]);
+        parity = 0 - (inside >> 63);
+    }
+    // cells past the right edge are never inside because every row crosses the loop an even number of times
+    return count;
+}
+
+uint64_t countInterior(const PipeGrid& grid) {
+    constexpr size_t rowsPerTask{64};
+    const size_t tasks{(grid.height + rowsPerTask - 1) / rowsPerTask};
+    std::vector<uint64_t> counts(tasks, 0);
+    utils::defaultPool().parallelFor(tasks, [&](size_t task) {
+        const size_t last{std::min(grid.height, (task + 1) * rowsPerTask)};
+        for (size_t y{task * rowsPerTask}; y < last; ++y) {
+            counts[task] += countRowInterior(grid, y);
+        }
+    });
+    return std::accumulate(counts.begin(), counts.end(), uint64_t{0});
+}
+
+uint64_t solution_one() {
+    try {
+        PipeGrid grid{input::inputContent};
+        return requireLoop(grid).length / 2;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_two() {
+    try {
+        PipeGrid grid{input::inputContent};
+        return interiorPoints(requireLoop(grid));
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_two_scanline() {
+    try {
+        PipeGrid grid{input::inputContent};
+        requireLoop(grid);
+        return countInterior(grid);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// Draws a closed loop through the given corners, consecutive corners must share a row or column.
+std::vector<std::string> renderLoop(const std::vector<std::pair<size_t, size_t>>& corners, size_t width, size_t height) {
+    std::vector<std::string> rows(height, std::string(width, '.'));
+    std::vector<uint8_t> masks(width * height, 0);
+    for (size_t c{0}; c < corners.size(); ++c) {
+        auto [x, y] = corners[c];
+        const auto [tx, ty] = corners[(c + 1) % corners.size()];
+        const uint8_t dir = tx > x ? east : tx < x ? west : ty > y ? south : north;
+        while (x != tx or y != ty) {
+            masks[y * width + x] |= bit(dir);
+            x = static_cast<size_t>(static_cast<int64_t>(x) + dx[dir]);
+            y = static_cast<size_t>(static_cast<int64_t>(y) + dy[dir]);
+            masks[y * width + x] |= bit(opposite(dir));
+        }
+    }
+    constexpr std::string_view pipes{"|-LJ7F"};
+    for (size_t index{0}; index < masks.size(); ++index) {
+        for (char pipe : pipes) {
+            if (masks[index] != 0 and charMasks[static_cast<uint8_t>(pipe)] == masks[index]) {
+                rows[index / width][index % width] = pipe;
+            }
+        }
+    }
+    return rows;
+}
+
+// A comb: the top row and right column, then teeth reaching up from the bottom row.
+std::vector<std::string> generateComb(size_t width, size_t height) {
+    std::vector<std::pair<size_t, size_t>> corners{{0, 0}, {width - 1, 0}, {width - 1, height - 1}};
+    for (size_t x{width - 1}; x >= 5; x -= 4) {
+        corners.emplace_back(x - 2, height - 1);
+        corners.emplace_back(x - 2, 2);
+        corners.emplace_back(x - 4, 2);
+        corners.emplace_back(x - 4, height - 1);
+    }
+    corners.emplace_back(0, height - 1);
+    auto rows{renderLoop(corners, width, height)};
+    rows[1][0] = 'S';
+    return rows;
+}
+
+// traces the loop of a generated 10000 x 10000 map
+void benchmark_large() {
+    try {
+        constexpr size_t size{10'000};
+        constexpr size_t n{3};
+        const std::vector<std::string> rows{generateComb(size, size)};
+
+        uint64_t farthest{0}, interior{0};
+        std::cout << size << "x" << size << " map, parse and trace:\n";
+        utils::benchmark<n>([&]() {
+            PipeGrid grid{rows};
+            const Loop loop{requireLoop(grid)};
+            farthest = loop.length / 2;
+            interior = interiorPoints(loop);
+        });
+        std::cout << "Farthest: " << farthest << ", interior: " << interior << '\n';
+
+        PipeGrid grid{rows};
+        requireLoop(grid);
+        uint64_t scanned{0};
+        std::cout << size << "x" << size << " map, scanline interior on " << utils::defaultPool().size() << " threads:\n";
+        utils::benchmark<n>([&]() { scanned = countInterior(grid); });
+        if (scanned != interior) {
+            throw std::logic_error("scanline and Pick's theorem disagree");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
@@ -338,5 +711,16 @@ int main() {
     std::cout << "Part 2: " << original::solution_two() << std::endl;
     utils::benchmark<n>(original::solution_two);
 
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    std::cout << "Part 2 (scanline): " << optimized::solution_two_scanline() << std::endl;
+    utils::benchmark<n>(optimized::solution_two_scanline);
+
+    optimized::benchmark_large();
+
     return 0;
 }
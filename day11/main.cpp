@@ -1,4 +1,6 @@
 #include <bitset>
+#include <filesystem>
+#include <random>
 #include <utility>
 
 #include "FileData.hpp"
@@ -99,6 +101,252 @@ long solution_two() {
 }
 }  // namespace original
 
+namespace optimized {
+
+using utils::uint128_t;
+
+// Galaxies per row and per column. Manhattan distance splits into the two axes, and a
+// histogram over an axis is that axis' coordinates already counting-sorted.
+struct Sky {
+    std::vector<uint64_t> rowCounts;
+    std::vector<uint64_t> columnCounts;
+
+    Sky() = default;
+
+    template <typename Lines>
+    explicit Sky(const Lines& lines) {
+        for (std::string_view line : lines) {
+            if (line.size() > columnCounts.size()) {
+                columnCounts.resize(line.size(), 0);
+            }
+            uint64_t galaxies{0};
+            for (size_t x{0}; x < line.size(); ++x) {
+                const bool galaxy = line[x] == '#';
+                columnCounts[x] += galaxy;
+                galaxies += galaxy;
+            }
+            rowCounts.push_back(galaxies);
+        }
+    }
+};
+
+// Sum of |a - b| over all pairs on one axis in a single sweep: each coordinate is at
+// least as large as everything before it, so it adds coordinate * before - sum(before).
+// Every empty line is widened to expansion lines.
+uint128_t axisDistances(const std::vector<uint64_t>& counts, uint64_t expansion) {
+    uint128_t total{0}, before{0}, sumBefore{0}, coordinate{0};
+    for (uint64_t count : counts) {
+        if (count == 0) {
+            coordinate += expansion;
+            continue;
+        }
+        total += count * (coordinate * before - sumBefore);
+        before += count;
+        sumBefore += count * coordinate;
+        coordinate += 1;
+    }
+    return total;
+}
+
+uint128_t galaxyDistances(const Sky& sky, uint64_t expansion) {
+    return axisDistances(sky.rowCounts, expansion) + axisDistances(sky.columnCounts, expansion);
+}
+
+// Reads an image in fixed size chunks, so rows can be arbitrarily wide and are never held in memory.
+Sky readSky(std::istream& in) {
+    constexpr size_t chunkSize{1 << 16};
+    Sky sky;
+    std::vector<char> chunk(chunkSize);
+    size_t x{0};
+    uint64_t rowGalaxies{0};
+    bool rowOpen{false};
+    while (in.read(chunk.data(), chunkSize) or in.gcount() > 0) {
+        const size_t read{static_cast<size_t>(in.gcount())};
+        for (size_t i{0}; i < read; ++i) {
+            const char c{chunk[i]};
+            if (c == '\n') {
+                sky.rowCounts.push_back(rowGalaxies);
+                rowGalaxies = 0;
+                x = 0;
+                rowOpen = false;
+                continue;
+            }
+            if (c == '\r') {
+                continue;
+            }
+            if (x == sky.columnCounts.size()) {
+                sky.columnCounts.push_back(0);
+            }
+            const bool galaxy = c == '#';
+            sky.columnCounts[x++] += galaxy;
+            rowGalaxies += galaxy;
+            rowOpen = true;
+        }
+    }
+    if (rowOpen) {
+        sky.rowCounts.push_back(rowGalaxies);
+    }
+    return sky;
+}
+
+// emptyBefore[i] is the number of empty lines before line i, built once per axis.
+std::vector<uint64_t> emptyPrefix(const std::vector<uint64_t>& counts) {
+    std::vector<uint64_t> emptyBefore(counts.size() + 1, 0);
+    for (size_t i{0}; i < counts.size(); ++i) {
+        emptyBefore[i + 1] = emptyBefore[i] + (counts[i] == 0);
+    }
+    return emptyBefore;
+}
+
+struct Galaxy {
+    uint64_t x;
+    uint64_t y;
+};
+
+// Expanded galaxy positions, one prefix count lookup per axis and galaxy.
+template <typename Lines>
+std::vector<Galaxy> expandGalaxies(const Lines& lines, uint64_t expansion) {
+    const Sky sky{lines};
+    const auto emptyRowsBefore{emptyPrefix(sky.rowCounts)};
+    const auto emptyColumnsBefore{emptyPrefix(sky.columnCounts)};
+    std::vector<Galaxy> galaxies;
+    size_t y{0};
+    for (std::string_view line : lines) {
+        for (size_t x{line.find('#')}; x != std::string_view::npos; x = line.find('#', x + 1)) {
+            galaxies.push_back(Galaxy{x + emptyColumnsBefore[x] * (expansion - 1), y + emptyRowsBefore[y] * (expansion - 1)});
+        }
+        ++y;
+    }
+    return galaxies;
+}
+
+// same sweep as axisDistances over explicit, sorted coordinates
+uint128_t sortedDistances(const std::vector<uint64_t>& coordinates) {
+    uint128_t total{0}, sumBefore{0};
+    for (size_t i{0}; i < coordinates.size(); ++i) {
+        total += static_cast<uint128_t>(coordinates[i]) * i - sumBefore;
+        sumBefore += coordinates[i];
+    }
+    return total;
+}
+
+uint128_t galaxyDistances(const std::vector<Galaxy>& galaxies) {
+    std::vector<uint64_t> xs, ys;
+    xs.reserve(galaxies.size());
+    ys.reserve(galaxies.size());
+    for (const auto& galaxy : galaxies) {
+        xs.push_back(galaxy.x);
+        ys.push_back(galaxy.y);  // rows are read in order, ys is sorted already
+    }
+    std::sort(xs.begin(), xs.end());
+    return sortedDistances(xs) + sortedDistances(ys);
+}
+
+uint64_t solve(uint64_t expansion) {
+    const uint128_t total{galaxyDistances(Sky{input::inputContent}, expansion)};
+    if (total > std::numeric_limits<uint64_t>::max()) {
+        throw std::overflow_error("sum of distances does not fit into 64 bits");
+    }
+    return static_cast<uint64_t>(total);
+}
+
+uint64_t solution_two_galaxies() {
+    try {
+        const uint128_t total{galaxyDistances(expandGalaxies(input::inputContent, 1'000'000))};
+        if (total > std::numeric_limits<uint64_t>::max()) {
+            throw std::overflow_error("sum of distances does not fit into 64 bits");
+        }
+        return static_cast<uint64_t>(total);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_one() {
+    try {
+        return solve(2);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_two() {
+    try {
+        return solve(1'000'000);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// a 10000 x 10000 sky with about 1e6 galaxies, clustered so that some rows and columns stay empty
+std::vector<std::string> generateSky(size_t size, uint64_t seed) {
+    std::mt19937_64 rng{seed};
+    std::vector<bool> emptyColumn(size);
+    for (size_t x{0}; x < size; ++x) {
+        emptyColumn[x] = rng() % 8 == 0;
+    }
+    std::vector<std::string> rows(size, std::string(size, '.'));
+    for (auto& row : rows) {
+        if (rng() % 8 == 0) {
+            continue;
+        }
+        for (size_t x{0}; x < size; ++x) {
+            if (!emptyColumn[x] and rng() % 77 == 0) {
+                row[x] = '#';
+            }
+        }
+    }
+    return rows;
+}
+
+void benchmark_large() {
+    try {
+        constexpr size_t size{10'000};
+        constexpr size_t n{5};
+        const std::vector<std::string> rows{generateSky(size, 2023)};
+
+        const Sky sky{rows};
+        const uint64_t galaxies = std::accumulate(sky.rowCounts.begin(), sky.rowCounts.end(), uint64_t{0});
+        uint128_t total{0};
+        std::cout << galaxies << " galaxies, parse and sum:\n";
+        utils::benchmark<n>([&]() { total = galaxyDistances(Sky{rows}, 1'000'000); });
+        std::cout << "Sum of distances: " << utils::toString(total) << '\n';
+
+        // 64 rows of a million columns each, streamed from a file
+        constexpr size_t wideRows{64};
+        constexpr size_t wideColumns{1'000'000};
+        const auto path = std::filesystem::temp_directory_path() / "day11_wide_sky.txt";
+        {
+            std::ofstream file(path);
+            std::mt19937_64 rng{7};
+            std::string row(wideColumns, '.');
+            for (size_t y{0}; y < wideRows; ++y) {
+                for (char& c : row) {
+                    c = rng() % 5000 == 0 ? '#' : '.';
+                }
+                file << row << '\n';
+            }
+        }
+        std::cout << wideRows << "x" << wideColumns << " sky, streamed:\n";
+        utils::benchmark<n>([&]() {
+            std::ifstream file(path);
+            if (!file.is_open()) {
+                throw std::runtime_error("Unable to open file: " + path.string());
+            }
+            total = galaxyDistances(readSky(file), 1'000'000);
+        });
+        std::filesystem::remove(path);
+        std::cout << "Sum of distances: " << utils::toString(total) << '\n';
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
@@ -108,5 +356,16 @@ int main() {
     std::cout << "Part 2: " << original::solution_two() << std::endl;
     utils::benchmark<n>(original::solution_two);
 
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    std::cout << "Part 2 (galaxy list): " << optimized::solution_two_galaxies() << std::endl;
+    utils::benchmark<n>(optimized::solution_two_galaxies);
+
+    optimized::benchmark_large();
+
     return 0;
 }
@@ -1,3 +1,11 @@
+#include <bit>
+#include <charconv>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <random>
+#include <tuple>
+
 #include "FileData.hpp"
 #include "utils.hpp"
 
@@ -157,6 +165,807 @@ uint64_t solution_two() {
 
 }  // namespace original
 
+namespace optimized {
+
+// Bottom-up arrangement count over flat buffers that are kept between records, so after the
+// first few records no call allocates. ways(j, i) is the number of ways to place groups j..
+// into conditions i.., only two rows over j are alive at a time.
+class ArrangementSolver {
+   public:
+    uint64_t count(std::string_view line, size_t unfold = 1) {
+        parse(line, unfold);
+        const size_t length{conditions_.size()};
+
+        // dots_[i] / hashes_[i]: number of '.' / '#' among the first i conditions
+        dots_.resize(length + 1);
+        hashes_.resize(length + 1);
+        dots_[0] = hashes_[0] = 0;
+        for (size_t i{0}; i < length; ++i) {
+            dots_[i + 1] = dots_[i] + (conditions_[i] == '.');
+            hashes_[i + 1] = hashes_[i] + (conditions_[i] == '#');
+        }
+
+        // index length + 1 stands for "past the end", reached after a group ending on the last spring
+        next_.resize(length + 2);
+        current_.resize(length + 2);
+        for (size_t i{0}; i <= length; ++i) {
+            next_[i] = hashes_[length] == hashes_[i];
+        }
+        next_[length + 1] = 1;
+
+        for (size_t j{groups_.size()}; j-- > 0;) {
+            const size_t run{groups_[j]};
+            current_[length] = current_[length + 1] = 0;
+            for (size_t i{length}; i-- > 0;) {
+                uint64_t ways = conditions_[i] != '#' ? current_[i + 1] : 0;
+                const size_t end{i + run};
+                if (end <= length and dots_[end] == dots_[i] and (end == length or conditions_[end] != '#')) {
+                    ways += next_[end + 1];
+                }
+                current_[i] = ways;
+            }
+            std::swap(current_, next_);
+        }
+        return next_[0];
+    }
+
+   private:
+    std::vector<char> conditions_;
+    std::vector<uint32_t> groups_;
+    std::vector<uint32_t> dots_;
+    std::vector<uint32_t> hashes_;
+    std::vector<uint64_t> next_;
+    std::vector<uint64_t> current_;
+
+    void parse(std::string_view line, size_t unfold) {
+        const size_t split{line.find(' ')};
+        if (split == std::string_view::npos or unfold == 0) {
+            throw std::invalid_argument("could not parse record");
+        }
+        const std::string_view springs{line.substr(0, split)};
+        const std::string_view groupsPart{line.substr(split + 1)};
+
+        conditions_.clear();
+        groups_.clear();
+        for (size_t copy{0}; copy < unfold; ++copy) {
+            if (copy > 0) {
+                conditions_.push_back('?');
+            }
+            for (char c : springs) {
+                if (c != '.' and c != '#' and c != '?') {
+                    throw std::invalid_argument("Invalid condition");
+                }
+                conditions_.push_back(c);
+            }
+            const char* head{groupsPart.data()};
+            const char* end{groupsPart.data() + groupsPart.size()};
+            while (head < end) {
+                uint32_t group{0};
+                auto [ptr, ec] = std::from_chars(head, end, group);
+                if (ec != std::errc() or group == 0) {
+                    throw std::runtime_error("Parsing error occurred");
+                }
+                groups_.push_back(group);
+                head = ptr + 1;  // skip ','
+            }
+        }
+    }
+};
+
+uint64_t solve(size_t unfold) {
+    ArrangementSolver solver;
+    uint64_t result{0};
+    for (const std::string_view line : input::inputContent) {
+        result += solver.count(line, unfold);
+    }
+    return result;
+}
+
+// Unfolding without building the unfolded record. The joints between copies are always '?', so
+// one segment ('?' followed by the springs) takes a state (groups consumed j, length r of the
+// run in progress) to the same set of successor states for every copy, up to a shift of j by a
+// multiple of the group count. That segment transfer is computed once per record, for each
+// j mod groups and r.
+//
+// After k copies a counted arrangement has its deviation j - k * groups inside a band, bounded
+// both by the slack of a copy (the springs left over once every group and its separator are
+// placed) and by the deviations walks through the transfer can reach. Without slack, or when no
+// cycle of the transfer that can still finish moves the deviation, the band has a fixed width:
+// the transfer restricted to it is composed by repeated squaring and the cost grows with
+// log(unfold). Otherwise the band widens linearly with the unfold factor and no fixed-size
+// transfer exists; the transfer is then applied unfold - 1 times to the vector of joint states,
+// dropping states that can no longer fit the groups left, and the cost stays quadratic in the
+// unfold factor.
+//
+// So a record falls back to stepping when it has slack and some cycle of its transfer that can
+// still finish moves the deviation (about half of the puzzle input), and at any factor too small
+// for the band times groups times log(unfold) to stay below unfold.
+class UnfoldedCounter {
+   public:
+    uint64_t count(std::string_view line, size_t unfold) {
+        size_t lo{0}, hi{firstCopy(line, unfold)};
+        const size_t m{groups_.size()};
+        const size_t total{m * unfold};
+
+        if (const auto band{squaringBand(hi, unfold)}) {
+            const auto [bandLo, bandHi] = *band;
+            return bandHi < bandLo ? 0 : countBySquaring(hi, static_cast<int64_t>(unfold), bandLo, bandHi);
+        }
+
+        // one segment per further copy
+        current_.resize((total + 1) * stride_, 0);
+        next_.resize((total + 1) * stride_, 0);
+        const size_t segment{springs_.size() + 1};
+        for (size_t copy{1}; copy < unfold; ++copy) {
+            std::fill(next_.begin() + lo * stride_, next_.begin() + std::min(hi + segment, total) * stride_ + stride_, 0);
+            for (size_t j{lo}; j <= hi; ++j) {
+                const size_t base{(j % m) * stride_};
+                for (size_t r{0}; r < stride_; ++r) {
+                    const uint64_t ways{current_[j * stride_ + r]};
+                    if (ways == 0) {
+                        continue;
+                    }
+                    for (uint32_t e{transferStart_[base + r]}; e < transferStart_[base + r + 1]; ++e) {
+                        const Transition& t{transfer_[e]};
+                        const size_t target{j + t.groups};
+                        if (target < total or (target == total and t.run == 0)) {
+                            next_[target * stride_ + t.run] += ways * t.ways;
+                        }
+                    }
+                }
+            }
+            std::swap(current_, next_);
+            std::tie(lo, hi) = prune(lo, std::min(hi + segment, total), (unfold - copy - 1) * segment, total);
+            if (lo > hi) {
+                return 0;
+            }
+        }
+
+        uint64_t result{hi == total ? current_[total * stride_] : 0};
+        if (lo < total and total <= hi + 1) {
+            result += current_[(total - 1) * stride_ + groups_[(total - 1) % m]];
+        }
+        return result;
+    }
+
+    // whether the deviation band of the record has a fixed width, i.e. count composes by squaring
+    // once the unfold factor is large enough
+    bool fixedBand(std::string_view line, size_t unfold) {
+        const size_t hi{firstCopy(line, unfold)};
+        return slack() == 0 or walkBounds(hi).has_value();
+    }
+
+    // whether count takes the squaring path for the record at this unfold factor
+    bool squares(std::string_view line, size_t unfold) {
+        const size_t hi{firstCopy(line, unfold)};
+        return squaringBand(hi, unfold).has_value();
+    }
+
+   private:
+    struct Transition {
+        uint32_t groups;  // groups completed or started across the segment
+        uint32_t run;
+        uint64_t ways;
+    };
+
+    struct Term {
+        int32_t shift;  // change of the deviation j - copies * groups
+        uint32_t run;
+        uint64_t ways;
+    };
+
+    std::string springs_;
+    std::vector<uint32_t> groups_;
+    std::vector<uint64_t> prefix_;
+    size_t stride_{0};
+    std::vector<uint32_t> transferStart_;
+    std::vector<Transition> transfer_;
+    std::vector<uint64_t> current_;
+    std::vector<uint64_t> next_;
+    std::vector<uint64_t> local_;
+    std::vector<uint64_t> localNext_;
+    std::vector<uint32_t> kernelStart_;
+    std::vector<Term> kernel_;
+    std::vector<uint32_t> squareStart_;
+    std::vector<Term> square_;
+    std::vector<uint64_t> accumulator_;
+
+    void parse(std::string_view line, size_t unfold) {
+        const size_t split{line.find(' ')};
+        if (split == std::string_view::npos or unfold == 0) {
+            throw std::invalid_argument("could not parse record");
+        }
+        springs_.assign(line.substr(0, split));
+        for (char c : springs_) {
+            if (c != '.' and c != '#' and c != '?') {
+                throw std::invalid_argument("Invalid condition");
+            }
+        }
+        groups_.clear();
+        const char* head{line.data() + split + 1};
+        const char* end{line.data() + line.size()};
+        while (head < end) {
+            uint32_t group{0};
+            auto [ptr, ec] = std::from_chars(head, end, group);
+            if (ec != std::errc() or group == 0) {
+                throw std::runtime_error("Parsing error occurred");
+            }
+            groups_.push_back(group);
+            head = ptr + 1;  // skip ','
+        }
+        if (groups_.empty()) {
+            throw std::runtime_error("Parsing error occurred");
+        }
+    }
+
+    // Parses the record, builds its segment transfer and runs the first copy; the states are
+    // left in current_ for j in [0, returned bound], the vectors only grow with that band.
+    size_t firstCopy(std::string_view line, size_t unfold) {
+        parse(line, unfold);
+        const size_t m{groups_.size()};
+        stride_ = *std::max_element(groups_.begin(), groups_.end()) + 1;
+        buildTransfer();
+
+        prefix_.assign(m + 1, 0);
+        for (size_t g{0}; g < m; ++g) {
+            prefix_[g + 1] = prefix_[g] + groups_[g];
+        }
+
+        current_.assign(stride_, 0);
+        next_.assign(stride_, 0);
+        current_[0] = 1;
+        size_t hi{0};
+        for (char c : springs_) {
+            hi = step(current_, next_, 0, hi, c, m * unfold);
+            std::swap(current_, next_);
+        }
+        return hi;
+    }
+
+    // One condition applied to the states with j in [lo, hi]; '#' may only start a group
+    // below limit. Returns the new upper bound of j.
+    size_t step(const std::vector<uint64_t>& from, std::vector<uint64_t>& to, size_t lo, size_t hi, char c, size_t limit) {
+        const size_t m{groups_.size()};
+        const size_t newHi{std::min(hi + 1, limit)};
+        to.resize(std::max(to.size(), (newHi + 1) * stride_));
+        std::fill(to.begin() + lo * stride_, to.begin() + (newHi + 1) * stride_, 0);
+        for (size_t j{lo}; j <= hi; ++j) {
+            const size_t group{groups_[j % m]};
+            for (size_t r{0}; r <= group; ++r) {
+                const uint64_t ways{from[j * stride_ + r]};
+                if (ways == 0) {
+                    continue;
+                }
+                if (c != '#') {
+                    if (r == 0) {
+                        to[j * stride_] += ways;
+                    } else if (r == group and j + 1 <= limit) {
+                        to[(j + 1) * stride_] += ways;
+                    }
+                }
+                if (c != '.' and j < limit and r < group) {
+                    to[j * stride_ + r + 1] += ways;
+                }
+            }
+        }
+        return newHi;
+    }
+
+    // transfer_ entries for the segment '?' + springs, starting from (p, r) for every p < groups
+    void buildTransfer() {
+        const size_t m{groups_.size()};
+        const size_t unbounded{std::numeric_limits<size_t>::max()};
+        transferStart_.assign(m * stride_ + 1, 0);
+        transfer_.clear();
+        for (size_t p{0}; p < m; ++p) {
+            for (size_t r{0}; r < stride_; ++r) {
+                transferStart_[p * stride_ + r] = static_cast<uint32_t>(transfer_.size());
+                if (r > groups_[p]) {
+                    continue;
+                }
+                local_.assign((p + springs_.size() + 3) * stride_, 0);
+                local_[p * stride_ + r] = 1;
+                size_t hi{step(local_, localNext_, p, p, '?', unbounded)};
+                std::swap(local_, localNext_);
+                for (char c : springs_) {
+                    hi = step(local_, localNext_, p, hi, c, unbounded);
+                    std::swap(local_, localNext_);
+                }
+                for (size_t j{p}; j <= hi; ++j) {
+                    for (size_t run{0}; run < stride_; ++run) {
+                        if (const uint64_t ways{local_[j * stride_ + run]}; ways != 0) {
+                            transfer_.push_back({static_cast<uint32_t>(j - p), static_cast<uint32_t>(run), ways});
+                        }
+                    }
+                }
+            }
+        }
+        transferStart_[m * stride_] = static_cast<uint32_t>(transfer_.size());
+    }
+
+    // springs still needed to finish every group from state (j, r) on
+    [[nodiscard]] size_t needed(size_t j, size_t r, size_t total) const {
+        if (j == total) {
+            return 0;
+        }
+        const size_t m{groups_.size()};
+        const size_t done{(j / m) * prefix_[m] + prefix_[j % m]};
+        const size_t remaining{(total / m) * prefix_[m] - done};
+        return remaining - r + (total - j - 1);
+    }
+
+    // Clears the states in [lo, hi] that cannot fit in the springs left and returns the
+    // band of j that still holds any state.
+    std::pair<size_t, size_t> prune(size_t lo, size_t hi, size_t left, size_t total) {
+        size_t newLo{hi + 1}, newHi{0};
+        for (size_t j{lo}; j <= hi; ++j) {
+            bool alive{false};
+            for (size_t r{0}; r < stride_; ++r) {
+                uint64_t& ways{current_[j * stride_ + r]};
+                if (ways != 0 and needed(j, r, total) > left) {
+                    ways = 0;
+                }
+                alive |= ways != 0;
+            }
+            if (alive) {
+                newLo = std::min(newLo, j);
+                newHi = j;
+            }
+        }
+        return {newLo, newHi};
+    }
+
+    // springs left in a copy after every group and the separator behind it
+    [[nodiscard]] int64_t slack() const {
+        return static_cast<int64_t>(springs_.size() + 1 - prefix_[groups_.size()] - groups_.size());
+    }
+
+    // Largest j whose first j groups, each with its separator, fit in x springs. Extended to
+    // negative x and j by the period of a copy, so deviations can be read off directly.
+    [[nodiscard]] int64_t lastGroupWithin(int64_t x) const {
+        const int64_t m{static_cast<int64_t>(groups_.size())};
+        const int64_t period{static_cast<int64_t>(prefix_[groups_.size()]) + m};
+        const int64_t q{x >= 0 ? x / period : -((period - 1 - x) / period)};
+        const int64_t rest{x - q * period};
+        int64_t t{0};
+        while (t + 1 < m and static_cast<int64_t>(prefix_[t + 1]) + t + 1 <= rest) {
+            ++t;
+        }
+        return q * m + t;
+    }
+
+    // Deviations j - k * groups a counted arrangement can have after k copies: the groups
+    // consumed fit in the springs read and the groups after the current one in those left.
+    [[nodiscard]] std::pair<int64_t, int64_t> deviationBounds(int64_t k, int64_t copies) const {
+        const int64_t m{static_cast<int64_t>(groups_.size())};
+        return {std::max(lastGroupWithin(-(copies - k) * slack() - 1), -k * m),
+                std::min(lastGroupWithin(k * slack() - 1), (copies - k) * m)};
+    }
+
+    [[nodiscard]] static size_t floorMod(int64_t value, int64_t modulus) {
+        const int64_t rest{value % modulus};
+        return static_cast<size_t>(rest < 0 ? rest + modulus : rest);
+    }
+
+    // Deviations reachable at any joint by walks through the segment transfer that start from
+    // the states after the first copy (j in [0, hi] in current_) and can still end in a final
+    // state. Bellman-Ford over (j mod groups, r); nullopt if a cycle on such walks moves the
+    // deviation, which makes the band grow with the unfold factor.
+    [[nodiscard]] std::optional<std::pair<int64_t, int64_t>> walkBounds(size_t hi) const {
+        const size_t m{groups_.size()};
+        const size_t states{m * stride_};
+        auto target = [&](size_t state, const Transition& t) {
+            return ((state / stride_ + t.groups) % m) * stride_ + t.run;
+        };
+
+        // states from which a final one is reachable: every group closed, or the last one full
+        std::vector<char> live(states, 0);
+        live[0] = 1;
+        live[(m - 1) * stride_ + groups_.back()] = 1;
+        for (bool changed{true}; changed;) {
+            changed = false;
+            for (size_t state{0}; state < states; ++state) {
+                for (uint32_t e{transferStart_[state]}; not live[state] and e < transferStart_[state + 1]; ++e) {
+                    if (live[target(state, transfer_[e])]) {
+                        live[state] = 1;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        constexpr int64_t unreached{std::numeric_limits<int64_t>::min()};
+        std::vector<int64_t> most(states, unreached), least(states, std::numeric_limits<int64_t>::max());
+        for (size_t j{0}; j <= hi; ++j) {
+            for (size_t r{0}; r < stride_; ++r) {
+                const size_t state{(j % m) * stride_ + r};
+                if (current_[j * stride_ + r] != 0 and live[state]) {
+                    most[state] = std::max(most[state], static_cast<int64_t>(j) - static_cast<int64_t>(m));
+                    least[state] = std::min(least[state], static_cast<int64_t>(j) - static_cast<int64_t>(m));
+                }
+            }
+        }
+        for (size_t round{0};; ++round) {
+            bool changed{false};
+            for (size_t state{0}; state < states; ++state) {
+                if (most[state] == unreached) {
+                    continue;
+                }
+                for (uint32_t e{transferStart_[state]}; e < transferStart_[state + 1]; ++e) {
+                    const size_t next{target(state, transfer_[e])};
+                    if (not live[next]) {
+                        continue;
+                    }
+                    const int64_t shift{static_cast<int64_t>(transfer_[e].groups) - static_cast<int64_t>(m)};
+                    if (most[next] == unreached or most[state] + shift > most[next]) {
+                        most[next] = most[state] + shift;
+                        changed = true;
+                    }
+                    if (least[state] + shift < least[next]) {
+                        least[next] = least[state] + shift;
+                        changed = true;
+                    }
+                }
+            }
+            if (not changed) {
+                break;
+            }
+            if (round == states) {
+                return std::nullopt;
+            }
+        }
+
+        std::pair<int64_t, int64_t> bounds{std::numeric_limits<int64_t>::max(), unreached};
+        for (size_t state{0}; state < states; ++state) {
+            if (most[state] != unreached) {
+                bounds.first = std::min(bounds.first, least[state]);
+                bounds.second = std::max(bounds.second, most[state]);
+            }
+        }
+        return bounds;
+    }
+
+    // kernel_ for one segment: the transfer as deviation shifts, limited to reach
+    void buildKernel(int64_t reach) {
+        const size_t m{groups_.size()};
+        kernelStart_.assign(m * stride_ + 1, 0);
+        kernel_.clear();
+        for (size_t state{0}; state < m * stride_; ++state) {
+            kernelStart_[state] = static_cast<uint32_t>(kernel_.size());
+            for (uint32_t e{transferStart_[state]}; e < transferStart_[state + 1]; ++e) {
+                const int64_t shift{static_cast<int64_t>(transfer_[e].groups) - static_cast<int64_t>(m)};
+                if (std::abs(shift) <= reach) {
+                    kernel_.push_back({static_cast<int32_t>(shift), transfer_[e].run, transfer_[e].ways});
+                }
+            }
+        }
+        kernelStart_[m * stride_] = static_cast<uint32_t>(kernel_.size());
+    }
+
+    // kernel_ composed with itself; shifts beyond reach cannot belong to a counted arrangement
+    void squareKernel(int64_t reach) {
+        const int64_t m{static_cast<int64_t>(groups_.size())};
+        const size_t cells{static_cast<size_t>(2 * reach + 1) * stride_};
+        accumulator_.assign(cells, 0);
+        squareStart_.assign(m * stride_ + 1, 0);
+        square_.clear();
+        for (int64_t p{0}; p < m; ++p) {
+            for (size_t r{0}; r < stride_; ++r) {
+                const size_t state{static_cast<size_t>(p) * stride_ + r};
+                squareStart_[state] = static_cast<uint32_t>(square_.size());
+                for (uint32_t e{kernelStart_[state]}; e < kernelStart_[state + 1]; ++e) {
+                    const Term& first{kernel_[e]};
+                    const size_t middle{floorMod(p + first.shift, m) * stride_ + first.run};
+                    for (uint32_t f{kernelStart_[middle]}; f < kernelStart_[middle + 1]; ++f) {
+                        const Term& second{kernel_[f]};
+                        const int64_t shift{static_cast<int64_t>(first.shift) + second.shift};
+                        if (std::abs(shift) <= reach) {
+                            accumulator_[static_cast<size_t>(shift + reach) * stride_ + second.run] += first.ways * second.ways;
+                        }
+                    }
+                }
+                for (size_t cell{0}; cell < cells; ++cell) {
+                    if (accumulator_[cell] != 0) {
+                        square_.push_back({static_cast<int32_t>(static_cast<int64_t>(cell / stride_) - reach), static_cast<uint32_t>(cell % stride_), accumulator_[cell]});
+                        accumulator_[cell] = 0;
+                    }
+                }
+            }
+        }
+        squareStart_[m * stride_] = static_cast<uint32_t>(square_.size());
+        std::swap(kernel_, square_);
+        std::swap(kernelStart_, squareStart_);
+    }
+
+    // states at deviations [lo, hi] in current_ advanced by kernel_ to the band [newLo, newHi]
+    void applyKernel(int64_t lo, int64_t hi, int64_t newLo, int64_t newHi) {
+        const int64_t m{static_cast<int64_t>(groups_.size())};
+        next_.assign(static_cast<size_t>(newHi - newLo + 1) * stride_, 0);
+        for (int64_t d{lo}; d <= hi; ++d) {
+            const size_t base{floorMod(d, m) * stride_};
+            for (size_t r{0}; r < stride_; ++r) {
+                const uint64_t ways{current_[static_cast<size_t>(d - lo) * stride_ + r]};
+                if (ways == 0) {
+                    continue;
+                }
+                for (uint32_t e{kernelStart_[base + r]}; e < kernelStart_[base + r + 1]; ++e) {
+                    const int64_t target{d + kernel_[e].shift};
+                    if (target >= newLo and target <= newHi) {
+                        next_[static_cast<size_t>(target - newLo) * stride_ + kernel_[e].run] += ways * kernel_[e].ways;
+                    }
+                }
+            }
+        }
+        std::swap(current_, next_);
+    }
+
+    // The deviation band when the remaining copies are composed by squaring, possibly empty.
+    // Squaring pays off once log(unfold) compositions over the band cost less than unfold steps.
+    [[nodiscard]] std::optional<std::pair<int64_t, int64_t>> squaringBand(size_t hi, size_t unfold) const {
+        const int64_t copies{static_cast<int64_t>(unfold)};
+        const int64_t rounds{static_cast<int64_t>(groups_.size() * std::bit_width(unfold))};
+        if (unfold <= 1 or rounds >= copies) {
+            return std::nullopt;
+        }
+        int64_t bandLo{lastGroupWithin(-(copies - 1) * slack() - 1)};
+        int64_t bandHi{lastGroupWithin(copies * slack() - 1)};
+        if (const auto walks{walkBounds(hi)}) {
+            bandLo = std::max(bandLo, walks->first);
+            bandHi = std::min(bandHi, walks->second);
+        }
+        if (bandHi >= bandLo and (bandHi - bandLo + 1) * rounds >= copies) {
+            return std::nullopt;
+        }
+        return std::pair<int64_t, int64_t>{bandLo, bandHi};
+    }
+
+    // The remaining copies as the binary powers of the segment kernel, applied to the states
+    // after the first copy (j in [0, hi] in current_). Every joint stays in [bandLo, bandHi].
+    uint64_t countBySquaring(size_t hi, int64_t copies, int64_t bandLo, int64_t bandHi) {
+        const int64_t m{static_cast<int64_t>(groups_.size())};
+        const int64_t reach{bandHi - bandLo};
+        auto bounds = [&](int64_t k) {
+            const auto [lo, top] = deviationBounds(k, copies);
+            return std::pair<int64_t, int64_t>{std::max(lo, bandLo), std::min(top, bandHi)};
+        };
+        auto [lo, top] = bounds(1);
+        if (lo > top) {
+            return 0;
+        }
+        next_.assign(static_cast<size_t>(top - lo + 1) * stride_, 0);
+        for (int64_t d{lo}; d <= top; ++d) {
+            if (d + m >= 0 and d + m <= static_cast<int64_t>(hi)) {
+                std::copy_n(current_.begin() + (d + m) * stride_, stride_, next_.begin() + (d - lo) * stride_);
+            }
+        }
+        std::swap(current_, next_);
+
+        buildKernel(reach);
+        int64_t joint{1}, length{1};
+        for (uint64_t left{static_cast<uint64_t>(copies - 1)}; left != 0; left >>= 1) {
+            if (left & 1) {
+                const auto [newLo, newTop] = bounds(joint + length);
+                if (newLo > newTop) {
+                    return 0;
+                }
+                applyKernel(lo, top, newLo, newTop);
+                joint += length;
+                lo = newLo;
+                top = newTop;
+            }
+            if (left > 1) {
+                squareKernel(reach);
+                length *= 2;
+            }
+        }
+
+        // every group closed, or the last one running to the end
+        uint64_t result{0};
+        if (lo <= 0 and 0 <= top) {
+            result += current_[static_cast<size_t>(-lo) * stride_];
+        }
+        if (lo <= -1 and -1 <= top) {
+            result += current_[static_cast<size_t>(-1 - lo) * stride_ + groups_.back()];
+        }
+        return result;
+    }
+};
+
+uint64_t solveUnfolded(size_t unfold) {
+    UnfoldedCounter counter;
+    uint64_t result{0};
+    for (const std::string_view line : input::inputContent) {
+        result += counter.count(line, unfold);
+    }
+    return result;
+}
+
+// DP work for a record is about (springs * unfold) * (groups * unfold).
+uint64_t estimateCost(std::string_view line, size_t unfold) {
+    const size_t split{line.find(' ')};
+    const uint64_t springs{split == std::string_view::npos ? line.size() : split};
+    const uint64_t groups{1 + static_cast<uint64_t>(std::count(line.begin(), line.end(), ','))};
+    return (springs + 1) * groups * unfold * unfold;
+}
+
+// Records sorted by estimated cost, most expensive first, and cut into batches of similar total
+// cost. The pool hands batches out one at a time, so the costly ones start early and the cheap
+// tail fills in the gaps. Each worker thread keeps its own solver buffers.
+template <typename Lines>
+uint64_t countArrangements(const Lines& lines, size_t unfold, utils::ThreadPool& pool) {
+    std::vector<std::pair<uint64_t, size_t>> order;
+    order.reserve(lines.size());
+    uint64_t totalCost{0};
+    for (size_t i{0}; i < lines.size(); ++i) {
+        order.emplace_back(estimateCost(lines[i], unfold), i);
+        totalCost += order.back().first;
+    }
+    std::sort(order.begin(), order.end(), std::greater<>());
+
+    constexpr size_t batchesPerThread{32};
+    const uint64_t batchCost{std::max<uint64_t>(1, totalCost / (pool.size() * batchesPerThread))};
+    std::vector<size_t> batchStarts{0};
+    uint64_t cost{0};
+    for (size_t k{0}; k < order.size(); ++k) {
+        cost += order[k].first;
+        if (cost >= batchCost and k + 1 < order.size()) {
+            batchStarts.push_back(k + 1);
+            cost = 0;
+        }
+    }
+    batchStarts.push_back(order.size());
+
+    std::vector<uint64_t> partial(batchStarts.size() - 1, 0);
+    pool.parallelFor(partial.size(), [&](size_t batch) {
+        thread_local ArrangementSolver solver;
+        uint64_t sum{0};
+        for (size_t k{batchStarts[batch]}; k < batchStarts[batch + 1]; ++k) {
+            sum += solver.count(lines[order[k].second], unfold);
+        }
+        partial[batch] = sum;
+    });
+    return std::accumulate(partial.begin(), partial.end(), uint64_t{0});
+}
+
+uint64_t solution_one() {
+    try {
+        return solve(1);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_two() {
+    try {
+        return solve(5);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_two_parallel() {
+    try {
+        return countArrangements(input::inputContent, 5, utils::defaultPool());
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// Random records: a valid arrangement with some springs hidden behind '?', and every
+// hundredth record all '?', which is far more expensive once unfolded.
+std::vector<std::string> generateRecords(size_t count, uint64_t seed) {
+    std::mt19937_64 rng{seed};
+    std::vector<std::string> records;
+    records.reserve(count);
+    for (size_t r{0}; r < count; ++r) {
+        std::string springs, groups;
+        const size_t groupCount{1 + rng() % 6};
+        for (size_t g{0}; g < groupCount; ++g) {
+            springs.append(rng() % 3, '.');
+            if (g > 0) {
+                springs.push_back('.');
+                groups.push_back(',');
+            }
+            const size_t run{1 + rng() % 4};
+            springs.append(run, '#');
+            groups += std::to_string(run);
+        }
+        springs.append(rng() % 3, '.');
+        const bool allUnknown{r % 100 == 0};
+        for (char& c : springs) {
+            if (allUnknown or rng() % 2 == 0) {
+                c = '?';
+            }
+        }
+        records.push_back(springs + ' ' + groups);
+    }
+    return records;
+}
+
+// part two on 1e6 generated records with 1, 2, 4, ... threads
+void benchmark_threads() {
+    try {
+        constexpr size_t recordCount{1'000'000};
+        const std::vector<std::string> records{generateRecords(recordCount, 2023)};
+        const size_t hardware{std::max(1u, std::thread::hardware_concurrency())};
+
+        uint64_t reference{0};
+        for (size_t threads{1}; threads <= std::max<size_t>(hardware, 4); threads *= 2) {
+            utils::ThreadPool pool{threads};
+            uint64_t result{0};
+            std::cout << "1e6 records unfolded 5x, " << threads << " thread(s):\n";
+            utils::benchmark<1>([&]() { result = countArrangements(records, 5, pool); });
+            if (threads == 1) {
+                reference = result;
+                std::cout << "Arrangements (mod 2^64): " << result << '\n';
+            } else if (result != reference) {
+                throw std::logic_error("thread count changed the result");
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// Larger unfold factors with the segment transfer, checked against the full DP where that
+// still finishes in reasonable time. Both wrap mod 2^64 in the same way. Records whose band
+// widens keep a cost quadratic in the factor, so the largest factors only run on the others,
+// each of which is first checked against the DP at a factor where it takes the squaring path.
+void benchmark_unfold() {
+    try {
+        for (size_t unfold : {5, 50, 500}) {
+            uint64_t result{0};
+            std::cout << "Unfolded " << unfold << "x (transfer):\n";
+            utils::benchmark<1>([&]() { result = solveUnfolded(unfold); });
+            std::cout << "Arrangements (mod 2^64): " << result << '\n';
+            if (unfold <= 50 and result != solve(unfold)) {
+                throw std::logic_error("transfer and DP disagree");
+            }
+        }
+
+        // every fixed band record against the DP at the smallest power of two factor that squares
+        UnfoldedCounter counter;
+        ArrangementSolver solver;
+        std::vector<std::string_view> fixed;
+        size_t squared{0};
+        for (const std::string_view line : input::inputContent) {
+            if (!counter.fixedBand(line, 1'000'000)) {
+                continue;
+            }
+            fixed.push_back(line);
+            for (size_t unfold{2}; unfold <= 1024; unfold *= 2) {
+                if (counter.squares(line, unfold)) {
+                    if (counter.count(line, unfold) != solver.count(line, unfold)) {
+                        throw std::logic_error("squared transfer and DP disagree");
+                    }
+                    ++squared;
+                    break;
+                }
+            }
+        }
+        std::cout << "Squared transfer agrees with the DP on " << squared << " of " << fixed.size() << " fixed band records\n";
+        for (size_t unfold : {5'000, 1'000'000}) {
+            uint64_t result{0};
+            std::cout << fixed.size() << " records with a fixed band unfolded " << unfold << "x (squared transfer):\n";
+            utils::benchmark<1>([&]() {
+                result = 0;
+                for (const std::string_view line : fixed) {
+                    result += counter.count(line, unfold);
+                }
+            });
+            std::cout << "Arrangements (mod 2^64): " << result << '\n';
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
@@ -166,5 +975,18 @@ int main() {
     std::cout << "Part 2: " << original::solution_two() << std::endl;
     utils::benchmark<n>(original::solution_two);
 
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    std::cout << "Part 2 (parallel): " << optimized::solution_two_parallel() << std::endl;
+    utils::benchmark<n>(optimized::solution_two_parallel);
+
+    optimized::benchmark_threads();
+
+    optimized::benchmark_unfold();
+
     return 0;
 }
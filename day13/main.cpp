@@ -1,3 +1,10 @@
+#include <array>
+#include <bit>
+#include <limits>
+#include <random>
+#include <span>
+#include <unordered_map>
+
 #include "FileData.hpp"
 #include "utils.hpp"
 
@@ -62,13 +69,13 @@ uint64_t solution_one() {
 
         for (const std::string_view line : input::inputContent) {
             if (line.empty()) {
-                result += Pattern{buffer}.symmetryResult<1>();
+                result += Pattern{buffer}.symmetryResult<0>();
                 buffer.clear();
             } else {
                 buffer.push_back(line);
             }
         }
-        result += Pattern{buffer}.symmetryResult<1>();
+        result += Pattern{buffer}.symmetryResult<0>();
 
         return result;
     } catch (const std::exception& e) {
@@ -100,6 +107,367 @@ uint64_t solution_two() {
 }
 }  // namespace original
 
+namespace optimized {
+
+// A pattern as bit rows and bit columns, both multiword: column c of a row lives in bit c % 64
+// of word c / 64, row r of a column likewise. The storage is owned by a PatternArena.
+struct Pattern {
+    size_t numRows;
+    size_t numCols;
+    size_t rowWords;  // words per row, ceil(numCols / 64)
+    size_t colWords;  // words per column, ceil(numRows / 64)
+    const uint64_t* rows;
+    const uint64_t* cols;
+};
+
+// Bit storage reused from pattern to pattern, so after the largest pattern has been seen
+// loading another one does not allocate.
+class PatternArena {
+   public:
+    Pattern load(std::span<const std::string_view> lines) {
+        if (lines.empty() or lines[0].empty()) {
+            throw std::invalid_argument("empty pattern");
+        }
+        const size_t numRows{lines.size()};
+        const size_t numCols{lines[0].size()};
+        const size_t rowWords{(numCols + 63) / 64};
+        const size_t colWords{(numRows + 63) / 64};
+
+        rows_.assign(numRows * rowWords, 0);
+        for (size_t r{0}; r < numRows; ++r) {
+            const std::string_view line{lines[r]};
+            if (line.size() != numCols) {
+                throw std::invalid_argument("ragged pattern");
+            }
+            bool invalid{false};
+            for (size_t w{0}; w < rowWords; ++w) {
+                uint64_t word{0};
+                for (size_t c{w * 64}, end{std::min(numCols, c + 64)}; c < end; ++c) {
+                    word |= uint64_t{line[c] == '#'} << (c % 64);
+                    invalid |= line[c] != '#' and line[c] != '.';
+                }
+                rows_[r * rowWords + w] = word;
+            }
+            if (invalid) {
+                throw std::invalid_argument("Invalid pattern character");
+            }
+        }
+
+        // columns from 64x64 blocks of rows
+        cols_.assign(numCols * colWords, 0);
+        std::array<uint64_t, 64> block;
+        for (size_t rowBlock{0}; rowBlock < colWords; ++rowBlock) {
+            for (size_t colBlock{0}; colBlock < rowWords; ++colBlock) {
+                const size_t rowCount{std::min<size_t>(64, numRows - rowBlock * 64)};
+                const size_t colCount{std::min<size_t>(64, numCols - colBlock * 64)};
+                const size_t size{std::bit_ceil(std::max(rowCount, colCount))};
+                for (size_t i{0}; i < size; ++i) {
+                    block[i] = i < rowCount ? rows_[(rowBlock * 64 + i) * rowWords + colBlock] : 0;
+                }
+                utils::transpose64(block, size);
+                for (size_t i{0}; i < colCount; ++i) {
+                    cols_[(colBlock * 64 + i) * colWords + rowBlock] = block[i];
+                }
+            }
+        }
+        return {numRows, numCols, rowWords, colWords, rows_.data(), cols_.data()};
+    }
+
+   private:
+    std::vector<uint64_t> rows_;
+    std::vector<uint64_t> cols_;
+};
+
+// Differences between two lines of `words` words, stopping as soon as the count passes limit.
+[[nodiscard]] inline uint32_t lineDiffs(const uint64_t* a, const uint64_t* b, size_t words, uint32_t limit) {
+    uint32_t diffs{0};
+    for (size_t w{0}; w < words and diffs <= limit; ++w) {
+        diffs += std::popcount(a[w] ^ b[w]);
+    }
+    return diffs;
+}
+
+// Sum of (m + 1) over the mirror lines after line m with exactly allowedDiffs differing bits.
+[[nodiscard]] uint32_t analyzeSymmetry(const uint64_t* lines, size_t count, size_t words, uint32_t allowedDiffs) {
+    uint32_t result{0};
+    if (words == 1) {
+        for (size_t m{0}; m + 1 < count; ++m) {
+            uint32_t diffs{0};
+            for (size_t lo{m + 1}, hi{m + 1}; lo-- > 0 and hi < count and diffs <= allowedDiffs; ++hi) {
+                diffs += std::popcount(lines[lo] ^ lines[hi]);
+            }
+            result += (diffs == allowedDiffs) * static_cast<uint32_t>(m + 1);
+        }
+        return result;
+    }
+    for (size_t m{0}; m + 1 < count; ++m) {
+        uint32_t diffs{0};
+        for (size_t lo{m + 1}, hi{m + 1}; lo-- > 0 and hi < count and diffs <= allowedDiffs; ++hi) {
+            diffs += lineDiffs(lines + lo * words, lines + hi * words, words, allowedDiffs - std::min(diffs, allowedDiffs));
+        }
+        result += (diffs == allowedDiffs) * static_cast<uint32_t>(m + 1);
+    }
+    return result;
+}
+
+[[nodiscard]] uint32_t symmetryResult(const Pattern& pattern, uint32_t allowedDiffs) {
+    const uint32_t vertical{analyzeSymmetry(pattern.cols, pattern.numCols, pattern.colWords, allowedDiffs)};
+    const uint32_t horizontal{analyzeSymmetry(pattern.rows, pattern.numRows, pattern.rowWords, allowedDiffs)};
+    return vertical + 100u * horizontal;
+}
+
+// Mirror lines in linear time for tall patterns. Equal lines get equal ids (hash, then exact
+// compare), so Manacher's algorithm over the id sequence gives, for every gap, how many line
+// pairs around it match exactly. A gap whose match reaches an edge is a clean mirror. For a
+// smudged mirror the first mismatching pair must differ in exactly one bit and every pair after
+// it must match again. Those pairs run out to the first or the last line, so they match exactly
+// when the ids from that end, read one way, share a long enough prefix with the ids read the
+// other way from the far end of the mirrored block; the Z-function of the id sequence against
+// its reverse gives every such common prefix at once, keeping the smudged case linear too.
+class MirrorFinder {
+   public:
+    // Same result as analyzeSymmetry for allowedDiffs 0 and 1.
+    uint32_t mirrorSum(const uint64_t* lines, size_t count, size_t words, uint32_t allowedDiffs) {
+        if (allowedDiffs > 1) {
+            return analyzeSymmetry(lines, count, words, allowedDiffs);
+        }
+        assignIds(lines, count, words);
+        evenRadii(count);
+        if (allowedDiffs == 1) {
+            reversedMatches(count);
+        }
+
+        uint32_t result{0};
+        for (size_t gap{1}; gap < count; ++gap) {
+            const size_t reach{std::min(gap, count - gap)};
+            const size_t radius{radii_[gap]};
+            if (allowedDiffs == 0) {
+                result += (radius >= reach) * static_cast<uint32_t>(gap);
+                continue;
+            }
+            if (radius >= reach) {
+                continue;
+            }
+            const size_t lo{gap - 1 - radius}, hi{gap + radius};
+            if (lineDiffs(lines + lo * words, lines + hi * words, words, 1) != 1) {
+                continue;
+            }
+            // pairs (lo - t, hi + t) for t = 1 .. tail, ending on the first or the last line
+            const size_t tail{reach - radius - 1};
+            const size_t matched{gap <= count - gap ? fromFirst_[count - 2 * gap] : fromLast_[2 * gap - count]};
+            result += (matched >= tail) * static_cast<uint32_t>(gap);
+        }
+        return result;
+    }
+
+   private:
+    std::unordered_map<uint64_t, uint32_t> table_;
+    std::vector<uint32_t> firstLine_;  // a line carrying each id
+    std::vector<uint32_t> ids_;
+    std::vector<uint32_t> radii_;
+    std::vector<uint32_t> fromFirst_;  // common prefix of the ids and the reversed ids from i on
+    std::vector<uint32_t> fromLast_;   // common prefix of the reversed ids and the ids from i on
+    std::vector<uint32_t> text_;
+    std::vector<uint32_t> z_;
+
+    [[nodiscard]] static uint64_t lineHash(const uint64_t* line, size_t words) {
+        uint64_t hash{words};
+        for (size_t w{0}; w < words; ++w) {
+            hash = (hash ^ line[w]) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+
+    void assignIds(const uint64_t* lines, size_t count, size_t words) {
+        table_.clear();
+        firstLine_.clear();
+        ids_.resize(count);
+        for (size_t i{0}; i < count; ++i) {
+            const uint64_t* line{lines + i * words};
+            // on a hash collision between different lines, probe the next key
+            for (uint64_t key{lineHash(line, words)};; ++key) {
+                const auto [it, inserted] = table_.try_emplace(key, static_cast<uint32_t>(firstLine_.size()));
+                if (inserted) {
+                    firstLine_.push_back(static_cast<uint32_t>(i));
+                }
+                const uint64_t* other{lines + firstLine_[it->second] * words};
+                if (std::equal(line, line + words, other)) {
+                    ids_[i] = it->second;
+                    break;
+                }
+            }
+        }
+    }
+
+    // radii_[gap]: number of matching pairs (gap - 1 - t, gap + t), Manacher for even palindromes
+    void evenRadii(size_t count) {
+        radii_.assign(count, 0);
+        size_t left{0}, right{0};  // rightmost palindrome found covers [left, right)
+        for (size_t gap{1}; gap < count; ++gap) {
+            size_t radius{gap < right ? std::min<size_t>(radii_[left + right - gap], right - gap) : 0};
+            while (gap + radius < count and radius < gap and ids_[gap + radius] == ids_[gap - 1 - radius]) {
+                ++radius;
+            }
+            radii_[gap] = static_cast<uint32_t>(radius);
+            if (gap + radius > right) {
+                left = gap - radius;
+                right = gap + radius;
+            }
+        }
+    }
+
+    // z_[i]: length of the common prefix of text_ and text_[i..]
+    void zFunction() {
+        const size_t length{text_.size()};
+        z_.assign(length, 0);
+        size_t left{0}, right{0};  // rightmost match found covers [left, right)
+        for (size_t i{1}; i < length; ++i) {
+            size_t match{i < right ? std::min<size_t>(z_[i - left], right - i) : 0};
+            while (i + match < length and text_[match] == text_[i + match]) {
+                ++match;
+            }
+            z_[i] = static_cast<uint32_t>(match);
+            if (i + match > right) {
+                left = i;
+                right = i + match;
+            }
+        }
+    }
+
+    // fromFirst_ / fromLast_ through the Z-function of one id order, a separator that is no id,
+    // and the other order
+    void reversedMatches(size_t count) {
+        constexpr uint32_t separator{std::numeric_limits<uint32_t>::max()};
+        const auto offset{static_cast<std::ptrdiff_t>(count) + 1};
+
+        text_.assign(ids_.begin(), ids_.end());
+        text_.push_back(separator);
+        text_.insert(text_.end(), ids_.rbegin(), ids_.rend());
+        zFunction();
+        fromFirst_.assign(z_.begin() + offset, z_.end());
+
+        text_.assign(ids_.rbegin(), ids_.rend());
+        text_.push_back(separator);
+        text_.insert(text_.end(), ids_.begin(), ids_.end());
+        zFunction();
+        fromLast_.assign(z_.begin() + offset, z_.end());
+    }
+};
+
+[[nodiscard]] uint32_t symmetryResult(const Pattern& pattern, uint32_t allowedDiffs, MirrorFinder& finder) {
+    const uint32_t vertical{finder.mirrorSum(pattern.cols, pattern.numCols, pattern.colWords, allowedDiffs)};
+    const uint32_t horizontal{finder.mirrorSum(pattern.rows, pattern.numRows, pattern.rowWords, allowedDiffs)};
+    return vertical + 100u * horizontal;
+}
+
+// Calls f(pattern) for every blank-line separated pattern in lines.
+template <typename Lines, typename F>
+void forEachPattern(const Lines& lines, F&& f) {
+    PatternArena arena;
+    std::vector<std::string_view> buffer;
+    for (const std::string_view line : lines) {
+        if (line.empty()) {
+            if (not buffer.empty()) {
+                f(arena.load(buffer));
+            }
+            buffer.clear();
+        } else {
+            buffer.push_back(line);
+        }
+    }
+    if (not buffer.empty()) {
+        f(arena.load(buffer));
+    }
+}
+
+uint64_t solve(uint32_t allowedDiffs) {
+    uint64_t result{0};
+    forEachPattern(input::inputContent, [&](const Pattern& pattern) { result += symmetryResult(pattern, allowedDiffs); });
+    return result;
+}
+
+uint64_t solution_one() {
+    try {
+        return solve(0);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_two() {
+    try {
+        return solve(1);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// Tall patterns: one random row repeated with sparse single-bit noise, which keeps most line
+// pairs equal and the pairwise scan long, with a clean or smudged mirror planted at a random gap.
+std::vector<std::string> generatePatterns(size_t count, size_t numRows, size_t numCols, uint64_t seed) {
+    std::mt19937_64 rng{seed};
+    std::vector<std::string> lines;
+    lines.reserve(count * (numRows + 1));
+    for (size_t p{0}; p < count; ++p) {
+        std::string baseRow(numCols, '.');
+        for (char& c : baseRow) {
+            c = rng() % 2 ? '#' : '.';
+        }
+        std::vector<std::string> rows(numRows, baseRow);
+        for (std::string& row : rows) {
+            if (rng() % 64 == 0) {
+                char& c{row[rng() % numCols]};
+                c = c == '#' ? '.' : '#';
+            }
+        }
+        const size_t gap{1 + rng() % (numRows - 1)};
+        for (size_t lo{gap}, hi{gap}; lo-- > 0 and hi < numRows; ++hi) {
+            rows[hi] = rows[lo];
+        }
+        if (p % 2 == 1) {
+            char& c{rows[rng() % numRows][rng() % numCols]};
+            c = c == '#' ? '.' : '#';
+        }
+        if (p > 0) {
+            lines.emplace_back();
+        }
+        lines.insert(lines.end(), rows.begin(), rows.end());
+    }
+    return lines;
+}
+
+// pairwise scan against the linear mirror finder on 64 generated 4096x64 patterns
+void benchmark_large() {
+    try {
+        const std::vector<std::string> lines{generatePatterns(64, 4096, 64, 13)};
+        for (uint32_t allowedDiffs : {0u, 1u}) {
+            uint64_t pairwise{0}, linear{0};
+            std::cout << "4096x64 patterns, " << allowedDiffs << " smudge(s), pairwise scan:\n";
+            utils::benchmark<1>([&]() {
+                pairwise = 0;
+                forEachPattern(lines, [&](const Pattern& pattern) { pairwise += symmetryResult(pattern, allowedDiffs); });
+            });
+            std::cout << "4096x64 patterns, " << allowedDiffs << " smudge(s), mirror finder:\n";
+            MirrorFinder finder;
+            utils::benchmark<1>([&]() {
+                linear = 0;
+                forEachPattern(lines, [&](const Pattern& pattern) { linear += symmetryResult(pattern, allowedDiffs, finder); });
+            });
+            if (pairwise != linear) {
+                throw std::logic_error("mirror finder disagrees with the pairwise scan");
+            }
+            std::cout << "Summary: " << linear << '\n';
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
@@ -109,5 +477,13 @@ int main() {
     std::cout << "Part 2: " << original::solution_two() << std::endl;
     utils::benchmark<n>(original::solution_two);
 
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    optimized::benchmark_large();
+
     return 0;
 }
@@ -1,3 +1,9 @@
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include <array>
+#include <bit>
 #include <unordered_map>
 
 #include "FileData.hpp"
@@ -213,6 +219,582 @@ uint64_t solution_two() {
 }
 }  // namespace original
 
+namespace optimized {
+
+// `count` lines of `bits` bits each, bit i of a line in bit i % 64 of word i / 64.
+struct Bitboard {
+    size_t count{0};
+    size_t bits{0};
+    size_t words{0};  // per line
+    std::vector<uint64_t> data;
+
+    Bitboard() = default;
+    Bitboard(size_t count, size_t bits) : count{count}, bits{bits}, words{(bits + 63) / 64}, data(count * words, 0) {}
+
+    [[nodiscard]] uint64_t* line(size_t i) { return data.data() + i * words; }
+    [[nodiscard]] const uint64_t* line(size_t i) const { return data.data() + i * words; }
+};
+
+// dst = transpose of src; dst must be src.bits lines of src.count bits
+void transpose(const Bitboard& src, Bitboard& dst) {
+    std::array<uint64_t, 64> block;
+    for (size_t lineBlock{0}; lineBlock < dst.words; ++lineBlock) {
+        for (size_t bitBlock{0}; bitBlock < src.words; ++bitBlock) {
+            const size_t lineCount{std::min<size_t>(64, src.count - lineBlock * 64)};
+            const size_t bitCount{std::min<size_t>(64, src.bits - bitBlock * 64)};
+            const size_t size{std::bit_ceil(std::max(lineCount, bitCount))};
+            for (size_t i{0}; i < size; ++i) {
+                block[i] = i < lineCount ? src.line(lineBlock * 64 + i)[bitBlock] : 0;
+            }
+            utils::transpose64(block, size);
+            for (size_t i{0}; i < bitCount; ++i) {
+                dst.line(bitBlock * 64 + i)[lineBlock] = block[i];
+            }
+        }
+    }
+}
+
+// number of set bits in [begin, end) of a line
+[[nodiscard]] inline uint32_t countRange(const uint64_t* line, size_t begin, size_t end) {
+    uint32_t total{0};
+    for (size_t w{begin / 64}; w * 64 < end; ++w) {
+        uint64_t word{line[w]};
+        if (w == begin / 64) {
+            word &= ~uint64_t{0} << (begin % 64);
+        }
+        if ((w + 1) * 64 > end) {
+            word &= ~(~uint64_t{0} << (end % 64));
+        }
+        total += std::popcount(word);
+    }
+    return total;
+}
+
+// sets the bits [begin, end) of a line
+inline void fillRange(uint64_t* line, size_t begin, size_t end) {
+    for (size_t w{begin / 64}; w * 64 < end; ++w) {
+        uint64_t word{~uint64_t{0}};
+        if (w == begin / 64) {
+            word &= ~uint64_t{0} << (begin % 64);
+        }
+        if ((w + 1) * 64 > end) {
+            word &= ~(~uint64_t{0} << (end % 64));
+        }
+        line[w] |= word;
+    }
+}
+
+// Runs of free cells between '#' stones. A run inside a single word is kept as its mask there,
+// grouped by line and word: word w of line i owns shorts[wordStarts[i * words + w] ..
+// wordStarts[i * words + w + 1]). Runs that cross a word boundary are kept as bit ranges, line i
+// owning longs[longStarts[i] .. longStarts[i + 1]).
+struct Segments {
+    struct Short {
+        uint64_t mask;
+        uint32_t low;
+        uint32_t length;
+    };
+
+    std::vector<uint32_t> wordStarts;
+    std::vector<Short> shorts;
+    std::vector<uint32_t> longStarts;
+    std::vector<std::pair<uint32_t, uint32_t>> longs;
+
+    explicit Segments(const Bitboard& cubes) {
+        wordStarts.reserve(cubes.count * cubes.words + 1);
+        longStarts.reserve(cubes.count + 1);
+        std::vector<std::pair<size_t, size_t>> runs;
+        for (size_t i{0}; i < cubes.count; ++i) {
+            longStarts.push_back(static_cast<uint32_t>(longs.size()));
+            runs.clear();
+            const uint64_t* line{cubes.line(i)};
+            size_t begin{0};
+            for (size_t w{0}; w < cubes.words; ++w) {
+                for (uint64_t stones{line[w]}; stones != 0; stones &= stones - 1) {
+                    const size_t bit{w * 64 + std::countr_zero(stones)};
+                    if (bit > begin) {
+                        runs.emplace_back(begin, bit);
+                    }
+                    begin = bit + 1;
+                }
+            }
+            if (cubes.bits > begin) {
+                runs.emplace_back(begin, cubes.bits);
+            }
+
+            auto run{runs.begin()};
+            for (size_t w{0}; w < cubes.words; ++w) {
+                wordStarts.push_back(static_cast<uint32_t>(shorts.size()));
+                for (; run != runs.end() and run->first / 64 == w; ++run) {
+                    const auto [first, end] = *run;
+                    if ((end - 1) / 64 != w) {
+                        longs.emplace_back(first, end);
+                        continue;
+                    }
+                    const uint32_t low{static_cast<uint32_t>(first % 64)}, length{static_cast<uint32_t>(end - first)};
+                    shorts.push_back({(~uint64_t{0} >> (64 - length)) << low, low, length});
+                }
+            }
+        }
+        wordStarts.push_back(static_cast<uint32_t>(shorts.size()));
+        longStarts.push_back(static_cast<uint32_t>(longs.size()));
+    }
+};
+
+// Rounded rocks and cube stones as bitboards, in rows (west/east tilts) and in columns
+// (north/south tilts). A tilt counts the rocks in each free segment and refills the segment
+// from the wall it rolls towards; the rocks are transposed between the two views.
+class Platform {
+   public:
+    template <typename Lines>
+    explicit Platform(const Lines& lines) : Platform(parse(lines)) {}
+
+    [[nodiscard]] size_t width() const { return width_; }
+    [[nodiscard]] size_t height() const { return height_; }
+    [[nodiscard]] const Bitboard& rocks() const { return rows_; }
+
+    void tiltNorth() {
+        transpose(rows_, cols_);
+        tilt(cols_, colSegments_, true);
+        transpose(cols_, rows_);
+    }
+
+    void spinCycle() {
+        transpose(rows_, cols_);
+        tilt(cols_, colSegments_, true);  // north
+        transpose(cols_, rows_);
+        tilt(rows_, rowSegments_, true);  // west
+        transpose(rows_, cols_);
+        tilt(cols_, colSegments_, false);  // south
+        transpose(cols_, rows_);
+        tilt(rows_, rowSegments_, false);  // east
+    }
+
+    // sum over rocks of their distance from the south edge
+    [[nodiscard]] uint64_t northLoad() const {
+        uint64_t load{0};
+        for (size_t y{0}; y < height_; ++y) {
+            load += countRange(rows_.line(y), 0, width_) * (height_ - y);
+        }
+        return load;
+    }
+
+   private:
+    struct Parsed {
+        Bitboard rocks;
+        Bitboard cubes;
+    };
+
+    size_t width_;
+    size_t height_;
+    Bitboard rows_;
+    Bitboard cols_;
+    Segments rowSegments_;
+    Segments colSegments_;
+    std::vector<uint32_t> longRocks_;  // tilt scratch
+
+    explicit Platform(Parsed parsed)
+        : width_{parsed.rocks.bits},
+          height_{parsed.rocks.count},
+          rows_{std::move(parsed.rocks)},
+          cols_{width_, height_},
+          rowSegments_{parsed.cubes},
+          colSegments_{transposed(parsed.cubes)} {}
+
+    template <typename Lines>
+    static Parsed parse(const Lines& lines) {
+        size_t height{0};
+        for (const std::string_view line : lines) {
+            height += not line.empty();
+        }
+        if (height == 0) {
+            throw std::invalid_argument("empty platform");
+        }
+        const size_t width{std::string_view{*std::begin(lines)}.size()};
+        Parsed parsed{Bitboard{height, width}, Bitboard{height, width}};
+        size_t y{0};
+        for (const std::string_view line : lines) {
+            if (line.empty()) {
+                continue;
+            }
+            if (line.size() != width) {
+                throw std::invalid_argument("ragged platform");
+            }
+            bool invalid{false};
+            for (size_t w{0}; w < parsed.rocks.words; ++w) {
+                uint64_t rocks{0}, cubes{0};
+                for (size_t x{w * 64}, end{std::min(width, x + 64)}; x < end; ++x) {
+                    rocks |= uint64_t{line[x] == 'O'} << (x % 64);
+                    cubes |= uint64_t{line[x] == '#'} << (x % 64);
+                    invalid |= line[x] != 'O' and line[x] != '#' and line[x] != '.';
+                }
+                parsed.rocks.line(y)[w] = rocks;
+                parsed.cubes.line(y)[w] = cubes;
+            }
+            if (invalid) {
+                throw std::invalid_argument("Invalid platform character");
+            }
+            ++y;
+        }
+        return parsed;
+    }
+
+    static Bitboard transposed(const Bitboard& board) {
+        Bitboard result{board.bits, board.count};
+        transpose(board, result);
+        return result;
+    }
+
+    // Rolls every rock to the low end (towards bit 0) or the high end of its run. Within a word
+    // the runs are disjoint, so all their counts come from the old word and the new word is just
+    // the union of the refilled runs; runs spanning words are counted first and refilled last.
+    void tilt(Bitboard& board, const Segments& segments, bool towardsLow) {
+        std::vector<uint32_t>& longRocks{longRocks_};
+        for (size_t i{0}; i < board.count; ++i) {
+            uint64_t* line{board.line(i)};
+            const uint32_t firstLong{segments.longStarts[i]}, lastLong{segments.longStarts[i + 1]};
+            longRocks.resize(std::max<size_t>(longRocks.size(), lastLong - firstLong));
+            for (uint32_t s{firstLong}; s < lastLong; ++s) {
+                longRocks[s - firstLong] = countRange(line, segments.longs[s].first, segments.longs[s].second);
+            }
+
+            const uint32_t* wordStart{&segments.wordStarts[i * board.words]};
+            for (size_t w{0}; w < board.words; ++w) {
+                const uint64_t old{line[w]};
+                uint64_t word{0};
+                for (uint32_t s{wordStart[w]}; s < wordStart[w + 1]; ++s) {
+                    const Segments::Short& run{segments.shorts[s]};
+                    const uint32_t rocks{static_cast<uint32_t>(std::popcount(old & run.mask))};
+                    const uint64_t filled{rocks == 0 ? 0 : ~uint64_t{0} >> (64 - rocks)};
+                    word |= filled << (towardsLow ? run.low : run.low + run.length - rocks);
+                }
+                line[w] = word;
+            }
+
+            for (uint32_t s{firstLong}; s < lastLong; ++s) {
+                const auto [begin, end] = segments.longs[s];
+                const uint32_t rocks{longRocks[s - firstLong]};
+                if (towardsLow) {
+                    fillRange(line, begin, begin + rocks);
+                } else {
+                    fillRange(line, end - rocks, end);
+                }
+            }
+        }
+    }
+};
+
+// 128-bit fingerprint of a rock layout: two independently mixed 64-bit lanes over the words.
+struct StateHash {
+    uint64_t low;
+    uint64_t high;
+
+    bool operator==(const StateHash&) const = default;
+
+    struct Hasher {
+        size_t operator()(const StateHash& hash) const { return hash.low; }
+    };
+};
+
+[[nodiscard]] StateHash hashState(const Bitboard& board) {
+    uint64_t low{0x243F6A8885A308D3ull}, high{0x13198A2E03707344ull};
+    for (const uint64_t word : board.data) {
+        low = (low ^ word) * 0x9E3779B97F4A7C15ull;
+        low ^= low >> 32;
+        high = std::rotl((high + word) * 0xC2B2AE3D27D4EB4Full, 31);
+    }
+    return {low ^ (low >> 29), high ^ (high >> 32)};
+}
+
+// Spin cycles until a rock layout repeats, then reads the load of the target cycle off the
+// per-cycle loads. Layouts are remembered by fingerprint only. A fingerprint hit at cycle c
+// pointing back to cycle s is checked exactly: the layout of cycle c is kept and compared
+// word for word with the layout c - s cycles later. A match proves cycle c starts a loop
+// whether or not the fingerprints collided, and costs one period of extra spins rather than
+// a replay of the lead-in. On a mismatch the search goes on.
+uint64_t loadAfterCycles(Platform platform, uint64_t target, size_t* storedBytes = nullptr) {
+    std::unordered_map<StateHash, uint32_t, StateHash::Hasher> seen;
+    std::vector<uint64_t> loads{platform.northLoad()};
+    seen.emplace(hashState(platform.rocks()), 0);
+    Bitboard candidate;
+    uint64_t candidateCycle{0};
+    uint64_t period{0};  // of the candidate under check, 0 when there is none
+    const auto report = [&]() {
+        if (storedBytes != nullptr) {
+            *storedBytes = seen.size() * (sizeof(StateHash) + sizeof(uint32_t) + sizeof(void*)) +
+                           seen.bucket_count() * sizeof(void*) + loads.capacity() * sizeof(uint64_t) +
+                           candidate.data.capacity() * sizeof(uint64_t);
+        }
+    };
+
+    for (uint64_t cycle{1}; cycle <= target; ++cycle) {
+        platform.spinCycle();
+        loads.push_back(platform.northLoad());
+        const auto [it, inserted] = seen.emplace(hashState(platform.rocks()), static_cast<uint32_t>(cycle));
+        if (period != 0) {
+            if (cycle < candidateCycle + period) {
+                continue;
+            }
+            if (platform.rocks().data == candidate.data) {
+                report();
+                return loads[candidateCycle + (target - candidateCycle) % period];
+            }
+            period = 0;
+        }
+        if (!inserted) {
+            candidate = platform.rocks();
+            candidateCycle = cycle;
+            period = cycle - it->second;
+        }
+    }
+    report();
+    return loads[target];
+}
+
+// The same with Brent's cycle detection, which keeps a constant number of layouts: the
+// period comes from a hare racing a tortoise that jumps to it at powers of two, the first
+// repeated cycle from a second pass with the two a period apart, after which the trailing
+// one walks on to the target's position in the first lap.
+uint64_t loadAfterCyclesBrent(const Platform& start, uint64_t target, size_t* storedBytes = nullptr) {
+    Platform hare{start};
+    Bitboard tortoise{start.rocks()};
+    hare.spinCycle();
+    uint64_t period{1};
+    for (uint64_t power{1}; tortoise.data != hare.rocks().data; ++period, hare.spinCycle()) {
+        if (period == power) {
+            tortoise = hare.rocks();
+            power *= 2;
+            period = 0;
+        }
+    }
+
+    Platform lead{start}, lag{start};
+    for (uint64_t i{0}; i < period; ++i) {
+        lead.spinCycle();
+    }
+    uint64_t first{0};
+    for (; first < target and lead.rocks().data != lag.rocks().data; ++first) {
+        lead.spinCycle();
+        lag.spinCycle();
+    }
+
+    const uint64_t position{target <= first ? target : first + (target - first) % period};
+    for (uint64_t i{first}; i < position; ++i) {
+        lag.spinCycle();
+    }
+    if (storedBytes != nullptr) {
+        *storedBytes = 4 * start.rocks().data.size() * sizeof(uint64_t);
+    }
+    return lag.northLoad();
+}
+
+// North load of the tilted platform straight from the rows, without moving any rock: each
+// column keeps the weight of its next free slot (height minus its row), a rock adds that weight
+// and takes the slot, a cube stone resets it to the weight of the row below the stone. With
+// AVX2 a 32-column strip is one byte compare per row, its weights live in 16-bit lanes and
+// the per-rock weights are summed into 32-bit lanes by madd; other columns run scalar.
+template <typename Lines>
+uint64_t streamNorthLoad(const Lines& lines) {
+    const size_t height{lines.size()};
+    if (height == 0) {
+        throw std::invalid_argument("empty platform");
+    }
+    const size_t width{std::string_view{lines[0]}.size()};
+    bool invalid{false};
+    uint64_t load{0};
+    size_t scalarFrom{0};
+
+#ifdef __AVX2__
+    if (height <= 32767) {
+        // madd reads lanes as signed, hence the height limit
+        struct Strip {
+            __m256i weightLow, weightHigh, sumLow, sumHigh;
+        };
+        const size_t strips{width / 32};
+        std::vector<Strip> state(strips);
+        const __m256i start{_mm256_set1_epi16(static_cast<int16_t>(height))};
+        for (Strip& strip : state) {
+            strip = {start, start, _mm256_setzero_si256(), _mm256_setzero_si256()};
+        }
+        const __m256i rockChar{_mm256_set1_epi8('O')}, cubeChar{_mm256_set1_epi8('#')}, dotChar{_mm256_set1_epi8('.')};
+        const __m256i ones{_mm256_set1_epi16(1)};
+        __m256i bad{_mm256_setzero_si256()};
+
+        for (size_t y{0}; y < height; ++y) {
+            const std::string_view line{lines[y]};
+            if (line.size() != width) {
+                throw std::invalid_argument("ragged platform");
+            }
+            const __m256i below{_mm256_set1_epi16(static_cast<int16_t>(height - y - 1))};
+            for (size_t s{0}; s < strips; ++s) {
+                const __m256i chars{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(line.data() + s * 32))};
+                const __m256i rocks{_mm256_cmpeq_epi8(chars, rockChar)};
+                const __m256i cubes{_mm256_cmpeq_epi8(chars, cubeChar)};
+                bad = _mm256_or_si256(bad, _mm256_xor_si256(_mm256_or_si256(_mm256_or_si256(rocks, cubes), _mm256_cmpeq_epi8(chars, dotChar)),
+                                                            _mm256_set1_epi8(-1)));
+
+                Strip& strip{state[s]};
+                const __m256i rocksLow{_mm256_cvtepi8_epi16(_mm256_castsi256_si128(rocks))};
+                const __m256i rocksHigh{_mm256_cvtepi8_epi16(_mm256_extracti128_si256(rocks, 1))};
+                const __m256i cubesLow{_mm256_cvtepi8_epi16(_mm256_castsi256_si128(cubes))};
+                const __m256i cubesHigh{_mm256_cvtepi8_epi16(_mm256_extracti128_si256(cubes, 1))};
+
+                strip.sumLow = _mm256_add_epi32(strip.sumLow, _mm256_madd_epi16(_mm256_and_si256(strip.weightLow, rocksLow), ones));
+                strip.sumHigh = _mm256_add_epi32(strip.sumHigh, _mm256_madd_epi16(_mm256_and_si256(strip.weightHigh, rocksHigh), ones));
+                // rock lanes are -1, so adding them takes the slot
+                strip.weightLow = _mm256_blendv_epi8(_mm256_add_epi16(strip.weightLow, rocksLow), below, cubesLow);
+                strip.weightHigh = _mm256_blendv_epi8(_mm256_add_epi16(strip.weightHigh, rocksHigh), below, cubesHigh);
+            }
+        }
+
+        invalid = not _mm256_testz_si256(bad, bad);
+        for (const Strip& strip : state) {
+            alignas(32) std::array<uint32_t, 16> sums;
+            _mm256_store_si256(reinterpret_cast<__m256i*>(sums.data()), strip.sumLow);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(sums.data() + 8), strip.sumHigh);
+            for (const uint32_t sum : sums) {
+                load += sum;
+            }
+        }
+        scalarFrom = strips * 32;
+    }
+#endif
+
+    std::vector<uint32_t> weights(width - scalarFrom, static_cast<uint32_t>(height));
+    for (size_t y{0}; y < height; ++y) {
+        const std::string_view line{lines[y]};
+        if (line.size() != width) {
+            throw std::invalid_argument("ragged platform");
+        }
+        for (size_t x{scalarFrom}; x < width; ++x) {
+            uint32_t& weight{weights[x - scalarFrom]};
+            const char c{line[x]};
+            load += c == 'O' ? weight : 0;
+            weight = c == '#' ? static_cast<uint32_t>(height - y - 1) : weight - (c == 'O');
+            invalid |= c != 'O' and c != '#' and c != '.';
+        }
+    }
+    if (invalid) {
+        throw std::invalid_argument("Invalid platform character");
+    }
+    return load;
+}
+
+uint64_t solution_one() {
+    try {
+        return streamNorthLoad(input::inputContent);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_two() {
+    try {
+        return loadAfterCycles(Platform{input::inputContent}, 1'000'000'000);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+uint64_t solution_two_brent() {
+    try {
+        return loadAfterCyclesBrent(Platform{input::inputContent}, 1'000'000'000);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// size x size platform tiled from the puzzle input; a random platform of that size takes
+// tens of thousands of cycles to repeat, the tiled one a few thousand
+std::vector<std::string> tilePlatform(size_t size) {
+    std::vector<std::string> lines(size, std::string(size, '.'));
+    for (size_t y{0}; y < size; ++y) {
+        const std::string_view tile{input::inputContent[y % input::inputContent.size()]};
+        for (size_t x{0}; x < size; ++x) {
+            lines[y][x] = tile[x % tile.size()];
+        }
+    }
+    return lines;
+}
+
+// part one on a 1000x1000 platform: streamed load against tilting the bitboard
+void benchmark_north() {
+    try {
+        const std::vector<std::string> lines{tilePlatform(1000)};
+        const Platform platform{lines};
+        uint64_t streamed{0}, tilted{0};
+
+        std::cout << "1000x1000 north load, streamed:\n";
+        utils::benchmark<100>([&]() { streamed = streamNorthLoad(lines); });
+        std::cout << "1000x1000 north load, bitboard tilt:\n";
+        utils::benchmark<100>([&]() {
+            Platform copy{platform};
+            copy.tiltNorth();
+            tilted = copy.northLoad();
+        });
+        if (streamed != tilted) {
+            throw std::logic_error("streamed and tilted loads disagree");
+        }
+        std::cout << "Load: " << streamed << '\n';
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// fingerprint map against Brent on a 1000x1000 platform: time and bytes of state kept
+void benchmark_large() {
+    try {
+        const std::vector<std::string> lines{tilePlatform(1000)};
+        const Platform platform{lines};
+        size_t hashedBytes{0}, brentBytes{0};
+        uint64_t hashed{0}, brent{0};
+
+        std::cout << "1000x1000 platform, fingerprint map:\n";
+        utils::benchmark<1>([&]() { hashed = loadAfterCycles(platform, 1'000'000'000, &hashedBytes); });
+        std::cout << "Load: " << hashed << ", state kept: " << hashedBytes / 1024 << " KiB\n";
+
+        std::cout << "1000x1000 platform, Brent:\n";
+        utils::benchmark<1>([&]() { brent = loadAfterCyclesBrent(platform, 1'000'000'000, &brentBytes); });
+        std::cout << "Load: " << brent << ", state kept: " << brentBytes / 1024 << " KiB\n";
+
+        if (hashed != brent) {
+            throw std::logic_error("fingerprint map and Brent disagree");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// one spin cycle of the bubble-pass version against the bitboard one
+void benchmark_cycle() {
+    try {
+        original::Platform reference{};
+        for (size_t y{0}; y < original::HEIGHT; ++y) {
+            for (size_t x{0}; x < original::WIDTH; ++x) {
+                reference[y][x] = input::inputContent[y][x];
+            }
+        }
+        Platform platform{input::inputContent};
+
+        std::cout << "Spin cycle (bubble passes):\n";
+        utils::benchmark<100>([&]() { original::runCycle(reference); });
+        std::cout << "Spin cycle (bitboard):\n";
+        utils::benchmark<100>([&]() { platform.spinCycle(); });
+        if (platform.northLoad() != original::calcLoad(reference)) {
+            throw std::logic_error("bitboard and bubble cycles disagree");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
@@ -222,5 +804,18 @@ int main() {
     std::cout << "Part 2: " << original::solution_two() << std::endl;
     utils::benchmark<n>(original::solution_two);
 
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    std::cout << "Part 2 (Brent): " << optimized::solution_two_brent() << std::endl;
+    utils::benchmark<n>(optimized::solution_two_brent);
+
+    optimized::benchmark_cycle();
+    optimized::benchmark_north();
+    optimized::benchmark_large();
+
     return 0;
 }
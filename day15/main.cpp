@@ -1,5 +1,16 @@
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <limits>
 #include <list>
 #include <optional>
+#include <random>
+#include <utility>
 
 #include "FileData.hpp"
 #include "utils.hpp"
@@ -180,6 +191,528 @@ uint64_t solution_two() {
 }
 }  // namespace original
 
+namespace optimized {
+
+// HASH is linear mod 256: a step c_a .. c_{b-1} ending before position b hashes to
+// sum c_j * 17^(b - j) = 17^b * sum c_j * 17^-j. As 17^16 = 1 mod 256, both factors only
+// depend on positions mod 16, i.e. on the byte lane of a 16-byte aligned block.
+constexpr std::array<uint8_t, 16> powers17{[]() {
+    std::array<uint8_t, 16> powers{};
+    uint8_t power{1};
+    for (uint8_t& p : powers) {
+        p = power;
+        power *= 17;
+    }
+    return powers;
+}()};
+
+constexpr std::array<uint8_t, 16> inversePowers17{[]() {
+    std::array<uint8_t, 16> powers{};
+    uint8_t power{1};
+    for (uint8_t& p : powers) {
+        p = power;
+        power *= 241;  // 17 * 241 = 4097 = 1 mod 256
+    }
+    return powers;
+}()};
+
+// sum of the step hashes, one byte at a time; a trailing newline is ignored
+uint64_t hashSumScalar(std::string_view data) {
+    while (not data.empty() and data.back() == '\n') {
+        data.remove_suffix(1);
+    }
+    uint64_t result{0};
+    uint8_t running{0};
+    for (const char c : data) {
+        if (c == ',') {
+            result += running;
+            running = 0;
+        } else {
+            running = static_cast<uint8_t>((running + static_cast<uint8_t>(c)) * 17);
+        }
+    }
+    return result + running;
+}
+
+#ifdef __AVX2__
+// bytewise a * b mod 256
+inline __m256i mulBytes(__m256i a, __m256i b) {
+    const __m256i low{_mm256_and_si256(_mm256_mullo_epi16(a, b), _mm256_set1_epi16(0x00FF))};
+    const __m256i high{_mm256_slli_epi16(_mm256_mullo_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8)), 8)};
+    return _mm256_or_si256(low, high);
+}
+
+// one round of a prefix sum within each 16-byte lane that restarts wherever seen is set
+template <int Shift>
+inline void scanStep(__m256i& sums, __m256i& seen) {
+    sums = _mm256_add_epi8(sums, _mm256_andnot_si256(seen, _mm256_slli_si256(sums, Shift)));
+    seen = _mm256_or_si256(seen, _mm256_slli_si256(seen, Shift));
+}
+#endif
+
+// Sum of the step hashes, 32 bytes per iteration with AVX2. Every byte is weighted with
+// 17^-lane, a segmented prefix sum restarting at commas (four shift-add rounds per 16-byte
+// lane) gives each comma the weighted sum of the step before it, and multiplying that by
+// 17^lane of the comma yields the step's hash, summed with sad. Steps crossing a lane or block
+// boundary carry their open sum along. The result equals hashSumScalar.
+uint64_t hashSum(std::string_view data) {
+    while (not data.empty() and data.back() == '\n') {
+        data.remove_suffix(1);
+    }
+#ifdef __AVX2__
+    const __m128i inverse128{_mm_loadu_si128(reinterpret_cast<const __m128i*>(inversePowers17.data()))};
+    const __m128i powers128{_mm_loadu_si128(reinterpret_cast<const __m128i*>(powers17.data()))};
+    const __m256i inverse{_mm256_set_m128i(inverse128, inverse128)};
+    const __m256i powers{_mm256_set_m128i(powers128, powers128)};
+    const __m256i comma{_mm256_set1_epi8(',')};
+    const __m256i firstByte{_mm256_set_epi64x(0, 0xFF, 0, 0xFF)};
+    __m256i total{_mm256_setzero_si256()};
+    uint8_t carry{0};  // weighted sum of the step still open at the block start
+
+    alignas(32) std::array<char, 32> tail{};
+    for (size_t offset{0}; offset < data.size(); offset += 32) {
+        const char* block{data.data() + offset};
+        if (data.size() - offset < 32) {
+            std::copy(block, data.data() + data.size(), tail.data());
+            block = tail.data();
+        }
+        const __m256i chars{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block))};
+        const __m256i heads{_mm256_cmpeq_epi8(chars, comma)};
+        __m256i sums{_mm256_andnot_si256(heads, mulBytes(chars, inverse))};
+        __m256i seen{heads};
+        scanStep<1>(sums, seen);
+        scanStep<2>(sums, seen);
+        scanStep<4>(sums, seen);
+        scanStep<8>(sums, seen);
+
+        // open sums entering each 16-byte lane
+        const uint8_t lowLast{static_cast<uint8_t>(_mm256_extract_epi8(sums, 15))};
+        const bool lowClosed{_mm256_extract_epi8(seen, 15) != 0};
+        const uint8_t highCarry{static_cast<uint8_t>(lowLast + (lowClosed ? 0 : carry))};
+        const __m256i carries{_mm256_set_m128i(_mm_set1_epi8(static_cast<char>(highCarry)), _mm_set1_epi8(static_cast<char>(carry)))};
+        sums = _mm256_add_epi8(sums, _mm256_andnot_si256(seen, carries));
+        carry = static_cast<uint8_t>(_mm256_extract_epi8(sums, 31));
+
+        // at a comma, the sum of the byte before it closes the step
+        const __m256i before{_mm256_or_si256(_mm256_slli_si256(sums, 1), _mm256_and_si256(carries, firstByte))};
+        const __m256i hashes{_mm256_and_si256(mulBytes(before, powers), heads)};
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(hashes, _mm256_setzero_si256()));
+    }
+
+    alignas(32) std::array<uint64_t, 4> lanes;
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes.data()), total);
+    // the last step ends at the end of the data
+    const uint8_t last{static_cast<uint8_t>(carry * powers17[data.size() % 16])};
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + last;
+#else
+    return hashSumScalar(data);
+#endif
+}
+
+uint64_t solution_one() {
+    try {
+        return hashSum(input::inputContent[0]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// Final mix of the 64-bit FNV-1a label fingerprint. Never 0, which marks free table cells.
+[[nodiscard]] inline uint64_t finishFingerprint(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    return hash == 0 ? 1 : hash;
+}
+
+// one step of the initialization sequence; focal length 0 stands for '-'
+struct Operation {
+    uint64_t fingerprint;
+    uint8_t box;
+    uint8_t focalLength;
+};
+
+// One pass over the sequence: the box hash and the fingerprint are built while the label is
+// read, then the operation and its focal length.
+std::vector<Operation> parseOperations(std::string_view data) {
+    while (not data.empty() and data.back() == '\n') {
+        data.remove_suffix(1);
+    }
+    std::vector<Operation> operations;
+    operations.reserve(data.size() / 6);
+    const char* head{data.data()};
+    const char* const end{data.data() + data.size()};
+    while (head < end) {
+        if (*head == ',') {
+            ++head;
+            continue;
+        }
+        uint8_t box{0};
+        uint64_t print{0xCBF29CE484222325ull};
+        const char* const labelStart{head};
+        for (; head < end and *head != '-' and *head != '=' and *head != ','; ++head) {
+            box = static_cast<uint8_t>((box + static_cast<uint8_t>(*head)) * 17);
+            print = (print ^ static_cast<uint8_t>(*head)) * 0x100000001B3ull;
+        }
+        if (head == labelStart or head == end or *head == ',') {
+            throw std::invalid_argument("Invalid input format");
+        }
+
+        uint8_t focalLength{0};
+        if (*head++ == '=') {
+            unsigned value{0};
+            auto [ptr, ec] = std::from_chars(head, end, value);
+            if (ec != std::errc() or value == 0 or value > 255) {
+                throw std::runtime_error("Parsing error occurred");
+            }
+            focalLength = static_cast<uint8_t>(value);
+            head = ptr;
+        }
+        if (head < end and *head != ',') {
+            throw std::invalid_argument("Invalid input format");
+        }
+        operations.push_back({finishFingerprint(print), box, focalLength});
+    }
+    return operations;
+}
+
+// Where each label's lens sits in its box, in an open-addressing table keyed by label
+// fingerprint. Two labels with the same 64-bit fingerprint would be taken for the same label.
+class LabelTable {
+   public:
+    static constexpr uint32_t absent{std::numeric_limits<uint32_t>::max()};
+
+    struct Entry {
+        uint64_t fingerprint{0};  // 0: free cell
+        uint32_t index{absent};   // position in its box
+    };
+
+    explicit LabelTable(size_t expectedLabels) : table_(std::bit_ceil(std::max<size_t>(16, expectedLabels * 2))) {}
+
+    // linear probing; the table stays at most half full
+    Entry& find(uint64_t key) {
+        const size_t mask{table_.size() - 1};
+        for (size_t cell{key & mask};; cell = (cell + 1) & mask) {
+            if (table_[cell].fingerprint == key or table_[cell].fingerprint == 0) {
+                return table_[cell];
+            }
+        }
+    }
+
+    Entry& claim(uint64_t key) {
+        Entry* entry{&find(key)};
+        if (entry->fingerprint == 0) {
+            if (2 * (used_ + 1) > table_.size()) {
+                grow();
+                entry = &find(key);
+            }
+            entry->fingerprint = key;
+            ++used_;
+        }
+        return *entry;
+    }
+
+   private:
+    std::vector<Entry> table_;
+    size_t used_{0};
+
+    void grow() {
+        std::vector<Entry> old(table_.size() * 2);
+        std::swap(old, table_);
+        for (const Entry& entry : old) {
+            if (entry.fingerprint != 0) {
+                find(entry.fingerprint) = entry;
+            }
+        }
+    }
+};
+
+struct Lens {
+    uint64_t fingerprint;
+    uint8_t focalLength;  // 0: removed
+};
+
+// one operation on its box; a removed lens stays behind as a tombstone
+inline void applyToBox(const Operation& operation, std::vector<Lens>& box, LabelTable& table) {
+    LabelTable::Entry& entry{table.claim(operation.fingerprint)};
+    if (operation.focalLength != 0) {
+        if (entry.index == LabelTable::absent) {
+            entry.index = static_cast<uint32_t>(box.size());
+            box.push_back({operation.fingerprint, operation.focalLength});
+        } else {
+            box[entry.index].focalLength = operation.focalLength;
+        }
+    } else if (entry.index != LabelTable::absent) {
+        box[entry.index].focalLength = 0;
+        entry.index = LabelTable::absent;
+    }
+}
+
+// The 256 boxes as vectors of lenses in insertion order, with removed lenses kept as
+// tombstones until scoring compacts the boxes. Replacing or removing a lens is one probe
+// sequence in the label table and a store.
+class LensBoxes {
+   public:
+    explicit LensBoxes(size_t expectedLabels = 1024) : table_(expectedLabels) {
+        // room for twice the average box up front; growing 256 vectors lens by lens costs more
+        // than the operations on a small sequence
+        for (std::vector<Lens>& box : boxes_) {
+            box.reserve(expectedLabels / 128 + 4);
+        }
+    }
+
+    void apply(const Operation& operation) { applyToBox(operation, boxes_[operation.box], table_); }
+
+    // Sum over lenses of (box + 1) * slot * focal length; drops the tombstones on the way.
+    uint64_t focusingPower() {
+        uint64_t power{0};
+        for (size_t b{0}; b < boxes_.size(); ++b) {
+            std::vector<Lens>& box{boxes_[b]};
+            size_t kept{0};
+            for (const Lens& lens : box) {
+                if (lens.focalLength == 0) {
+                    continue;
+                }
+                table_.find(lens.fingerprint).index = static_cast<uint32_t>(kept);
+                box[kept++] = lens;
+                power += (b + 1) * kept * lens.focalLength;
+            }
+            box.resize(kept);
+        }
+        return power;
+    }
+
+   private:
+    std::array<std::vector<Lens>, 256> boxes_;
+    LabelTable table_;
+};
+
+uint64_t solution_two() {
+    try {
+        LensBoxes boxes;
+        for (const Operation& operation : parseOperations(input::inputContent[0])) {
+            boxes.apply(operation);
+        }
+        return boxes.focusingPower();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// Operations only interact within their box, so the sequence splits into 256 independent
+// streams. Phase one parses chunks of the sequence in parallel and buckets the operations by
+// box, keeping sequence order within each box; phase two replays every box on its own and
+// the focusing powers of the boxes are summed.
+uint64_t focusingPowerPartitioned(std::string_view data, utils::ThreadPool& pool) {
+    while (not data.empty() and data.back() == '\n') {
+        data.remove_suffix(1);
+    }
+
+    // chunk starts moved past the next comma, so no step is cut in two
+    constexpr size_t chunksPerThread{4};
+    const size_t chunkCount{std::max<size_t>(1, std::min(pool.size() * chunksPerThread, data.size() / 4096))};
+    std::vector<size_t> chunkStarts{0};
+    for (size_t c{1}; c < chunkCount; ++c) {
+        const size_t comma{data.find(',', std::max(chunkStarts.back(), data.size() / chunkCount * c))};
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        chunkStarts.push_back(comma + 1);
+    }
+    chunkStarts.push_back(data.size());
+
+    const size_t chunks{chunkStarts.size() - 1};
+    std::vector<std::vector<Operation>> parsed(chunks);
+    std::vector<std::array<size_t, 256>> offsets(chunks);
+    pool.parallelFor(chunks, [&](size_t c) {
+        parsed[c] = parseOperations(data.substr(chunkStarts[c], chunkStarts[c + 1] - chunkStarts[c]));
+        offsets[c].fill(0);
+        for (const Operation& operation : parsed[c]) {
+            ++offsets[c][operation.box];
+        }
+    });
+
+    // exclusive prefix sum over (box, chunk), so each box is contiguous and in sequence order
+    std::array<size_t, 257> boxStarts{};
+    size_t total{0};
+    for (size_t b{0}; b < 256; ++b) {
+        boxStarts[b] = total;
+        for (size_t c{0}; c < chunks; ++c) {
+            total += std::exchange(offsets[c][b], total);
+        }
+    }
+    boxStarts[256] = total;
+
+    std::vector<Operation> byBox(total);
+    pool.parallelFor(chunks, [&](size_t c) {
+        for (const Operation& operation : parsed[c]) {
+            byBox[offsets[c][operation.box]++] = operation;
+        }
+        std::vector<Operation>{}.swap(parsed[c]);
+    });
+
+    std::array<uint64_t, 256> powers{};
+    pool.parallelFor(256, [&](size_t b) {
+        const size_t count{boxStarts[b + 1] - boxStarts[b]};
+        LabelTable table{std::min<size_t>(count, 1 << 16)};
+        std::vector<Lens> box;
+        for (size_t i{boxStarts[b]}; i < boxStarts[b + 1]; ++i) {
+            applyToBox(byBox[i], box, table);
+        }
+        uint64_t slot{0}, power{0};
+        for (const Lens& lens : box) {
+            if (lens.focalLength != 0) {
+                power += ++slot * lens.focalLength;
+            }
+        }
+        powers[b] = (b + 1) * power;
+    });
+
+    uint64_t power{0};
+    for (const uint64_t p : powers) {
+        power += p;
+    }
+    return power;
+}
+
+uint64_t solution_two_parallel() {
+    try {
+        return focusingPowerPartitioned(input::inputContent[0], utils::defaultPool());
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// Comma separated steps over labelCount random labels of 2 to 8 lowercase letters, each
+// removed ('-') one time in four and otherwise set to a focal length 1 to 9.
+std::string generateSequence(size_t steps, size_t labelCount, uint64_t seed) {
+    std::mt19937_64 rng{seed};
+    std::vector<std::string> labels(labelCount);
+    for (std::string& label : labels) {
+        label.resize(2 + rng() % 7);
+        for (char& c : label) {
+            c = static_cast<char>('a' + rng() % 26);
+        }
+    }
+    std::string sequence;
+    sequence.reserve(steps * 8);
+    for (size_t step{0}; step < steps; ++step) {
+        if (step > 0) {
+            sequence.push_back(',');
+        }
+        const uint64_t roll{rng()};
+        sequence += labels[roll % labelCount];
+        if ((roll >> 32) % 4 == 0) {
+            sequence.push_back('-');
+        } else {
+            sequence.push_back('=');
+            sequence.push_back(static_cast<char>('1' + (roll >> 40) % 9));
+        }
+    }
+    return sequence;
+}
+
+// byte-at-a-time HASH against the vector kernel on a 2 GiB generated sequence
+void benchmark_hash() {
+    try {
+        // a 16 MB generated block repeated up to 2 GiB, cheaper than generating all of it
+        const std::string block{generateSequence(2'000'000, 100'000, 15)};
+        constexpr size_t targetSize{size_t{2} << 30};
+        std::string sequence;
+        sequence.reserve(targetSize + block.size() + 1);
+        sequence = block;
+        while (sequence.size() < targetSize) {
+            sequence += ',';
+            sequence += block;
+        }
+        const double gigabytes{static_cast<double>(sequence.size()) / 1e9};
+        uint64_t scalar{0}, vector{0};
+
+        std::cout << "HASH sum over " << gigabytes << " GB, byte at a time:\n";
+        utils::benchmark<1>([&]() { scalar = original::hashOnTheFly(sequence); });
+        std::cout << "HASH sum over " << gigabytes << " GB, vector kernel:\n";
+        std::chrono::duration<double> elapsed{};
+        utils::benchmark<1>([&]() {
+            const auto start{std::chrono::steady_clock::now()};
+            vector = hashSum(sequence);
+            elapsed = std::chrono::steady_clock::now() - start;
+        });
+        if (scalar != vector) {
+            throw std::logic_error("vector kernel and byte loop disagree");
+        }
+        std::cout << "Sum: " << vector << ", " << gigabytes / elapsed.count() << " GB/s\n";
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// list boxes against the open-addressed ones on 1e7 operations over 1e5 labels
+void benchmark_boxes() {
+    try {
+        const std::string sequence{generateSequence(10'000'000, 100'000, 49)};
+        uint64_t listPower{0}, power{0};
+
+        std::cout << "1e7 operations over 1e5 labels, list boxes:\n";
+        utils::benchmark<1>([&]() {
+            std::array<std::list<original::Lens>, 256> boxes{original::constructBoxes(sequence)};
+            listPower = original::focusingPower(boxes);
+        });
+        std::cout << "1e7 operations over 1e5 labels, open-addressed boxes (parse + apply + score):\n";
+        utils::benchmark<1>([&]() {
+            LensBoxes boxes{100'000};
+            for (const Operation& operation : parseOperations(sequence)) {
+                boxes.apply(operation);
+            }
+            power = boxes.focusingPower();
+        });
+        // the list version sums in 32 bits
+        if (static_cast<uint32_t>(power) != static_cast<uint32_t>(listPower)) {
+            throw std::logic_error("open-addressed and list boxes disagree");
+        }
+        std::cout << "Focusing power: " << power << '\n';
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+
+// the single-table replay against the box-partitioned one for growing thread counts
+void benchmark_partitioned() {
+    try {
+        const std::string sequence{generateSequence(20'000'000, 1'000'000, 50)};
+        const size_t hardware{std::max(1u, std::thread::hardware_concurrency())};
+        uint64_t reference{0};
+
+        std::cout << "2e7 operations over 1e6 labels, single table:\n";
+        utils::benchmark<1>([&]() {
+            LensBoxes boxes{1'000'000};
+            for (const Operation& operation : parseOperations(sequence)) {
+                boxes.apply(operation);
+            }
+            reference = boxes.focusingPower();
+        });
+        std::cout << "Focusing power: " << reference << '\n';
+
+        for (size_t threads{1}; threads <= std::max<size_t>(hardware, 4); threads *= 2) {
+            utils::ThreadPool pool{threads};
+            uint64_t power{0};
+            std::cout << "2e7 operations over 1e6 labels, partitioned by box, " << threads << " thread(s):\n";
+            utils::benchmark<1>([&]() { power = focusingPowerPartitioned(sequence, pool); });
+            if (power != reference) {
+                throw std::logic_error("partitioned replay disagrees with the single table");
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
+}  // namespace optimized
+
 int main() {
     constexpr size_t n{100};
 
@@ -189,5 +722,18 @@ int main() {
     std::cout << "Part 2: " << original::solution_two() << std::endl;
     utils::benchmark<n>(original::solution_two);
 
+    std::cout << "Part 1 (optimized): " << optimized::solution_one() << std::endl;
+    utils::benchmark<n>(optimized::solution_one);
+
+    std::cout << "Part 2 (optimized): " << optimized::solution_two() << std::endl;
+    utils::benchmark<n>(optimized::solution_two);
+
+    std::cout << "Part 2 (parallel): " << optimized::solution_two_parallel() << std::endl;
+    utils::benchmark<n>(optimized::solution_two_parallel);
+
+    optimized::benchmark_hash();
+    optimized::benchmark_boxes();
+    optimized::benchmark_partitioned();
+
     return 0;
 }